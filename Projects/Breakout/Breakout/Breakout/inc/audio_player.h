@@ -0,0 +1,113 @@
+/*******************************************************************
+** This code is part of Breakout.
+**
+** Breakout is free software: you can redistribute it and/or modify
+** it under the terms of the CC BY 4.0 license as published by
+** Creative Commons, either version 4 of the License, or (at your
+** option) any later version.
+******************************************************************/
+#ifndef AUDIO_PLAYER_H
+#define AUDIO_PLAYER_H
+
+#include <atomic>
+#include <chrono>
+#include <thread>
+#include <vector>
+
+#include <glad/glad.h>
+
+#include "spsc_queue.h"
+
+
+// Identifies a sound loaded by an AudioPlayer
+typedef GLuint SoundHandle;
+
+// Number of sounds that can play at once
+const GLuint MAX_VOICES = 32;
+// Number of play requests that can be waiting for the audio thread (more are dropped)
+const GLuint AUDIO_QUEUE_SIZE = 256;
+
+
+// The sound library an AudioPlayer plays through. Sounds are loaded from the
+// thread that owns the AudioPlayer before it is started; everything else is
+// only ever called from the audio thread.
+class AudioBackend
+{
+public:
+    virtual ~AudioBackend() { }
+    // Loads (and unless it is streamed, decodes) a sound file, returns whether it could be loaded
+    virtual GLboolean Load(SoundHandle sound, const GLchar *file, GLboolean stream) = 0;
+    // Starts playing a loaded sound on a voice, returns GL_FALSE if it couldn't be played
+    virtual GLboolean Play(GLuint voice, SoundHandle sound, GLboolean loop) = 0;
+    // Whether the voice's sound ended
+    virtual GLboolean IsFinished(GLuint voice) = 0;
+    // Stops the voice's sound (if it is still playing) and frees the voice
+    virtual void      Release(GLuint voice) = 0;
+};
+
+// Plays nothing, for headless runs or when no audio device is available.
+// Sounds end as soon as they are started.
+class NullAudioBackend : public AudioBackend
+{
+public:
+    GLboolean Load(SoundHandle /*sound*/, const GLchar * /*file*/, GLboolean /*stream*/) { return GL_TRUE; }
+    GLboolean Play(GLuint /*voice*/, SoundHandle /*sound*/, GLboolean /*loop*/) { return GL_TRUE; }
+    GLboolean IsFinished(GLuint /*voice*/) { return GL_TRUE; }
+    void      Release(GLuint /*voice*/) { }
+};
+
+
+// AudioPlayer plays the game's sounds on its own thread. All sounds are loaded
+// once, at start up, and are played by handle. Play() only pushes a request on
+// a lock-free queue, so it never blocks (requests are dropped if the queue is
+// full). The audio thread hands out a fixed pool of voices, limiting the number
+// of voices per sound and how soon a sound can be started again.
+class AudioPlayer
+{
+public:
+    // Number of play requests that were dropped because the queue was full, or because of the limits of the sound or the voice pool
+    std::atomic<GLuint> Dropped;
+    // Constructor (takes ownership of the backend)
+    AudioPlayer(AudioBackend *backend);
+    // Destructor (stops all sounds and the audio thread)
+    ~AudioPlayer();
+    // Loads a sound that plays on at most maxVoices voices at once and can't be restarted within cooldown seconds.
+    // Long sounds (music) should be streamed instead of decoded up front. Must be called before Start().
+    SoundHandle Load(const GLchar *file, GLuint maxVoices = MAX_VOICES, GLfloat cooldown = 0.0f, GLboolean stream = GL_FALSE);
+    // Starts the audio thread
+    void Start();
+    // Requests a sound to be played (from the thread that owns the AudioPlayer)
+    void Play(SoundHandle sound, GLboolean loop = GL_FALSE);
+private:
+    typedef std::chrono::steady_clock Clock;
+    // A loaded sound and its limits
+    struct Sound
+    {
+        GLuint            MaxVoices;
+        Clock::duration   Cooldown;
+        // Audio thread state
+        GLuint            Voices;    // Number of voices playing it
+        Clock::time_point LastStart;
+    };
+    // A request to play a sound
+    struct PlayRequest
+    {
+        SoundHandle Sound;
+        GLboolean   Loop;
+    };
+    AudioBackend *           backend;
+    std::vector<Sound>       sounds;
+    SPSCQueue<PlayRequest, AUDIO_QUEUE_SIZE> requests;
+    // Sound playing on each voice (-1 for free voices), only used by the audio thread
+    GLint                    voices[MAX_VOICES];
+    std::thread              thread;
+    std::atomic<GLboolean>   running;
+    // Body of the audio thread
+    void run();
+    // Starts a requested sound if its limits and the voice pool allow it
+    void start(const PlayRequest &request);
+    // Frees the voices whose sound ended
+    void reclaimVoices();
+};
+
+#endif
@@ -0,0 +1,43 @@
+/*******************************************************************
+** This code is part of Breakout.
+**
+** Breakout is free software: you can redistribute it and/or modify
+** it under the terms of the CC BY 4.0 license as published by
+** Creative Commons, either version 4 of the License, or (at your
+** option) any later version.
+******************************************************************/
+#ifndef FRAME_CONSTANTS_H
+#define FRAME_CONSTANTS_H
+
+#include <glad/glad.h>
+#include <glm/glm.hpp>
+
+
+// State that is shared by all of Breakout's shaders and changes at most once per frame.
+// Mirrors the std140 layout of the FrameConstants uniform block declared in the shaders.
+struct FrameConstants
+{
+    glm::mat4 Projection;
+    GLfloat   Time;
+    GLint     Confuse;
+    GLint     Chaos;
+    GLint     Shake;
+};
+
+// FrameConstantsBuffer hosts the uniform buffer that backs the FrameConstants block.
+// The buffer stays bound to FRAME_CONSTANTS_BINDING, so uploading the constants once
+// per frame is all it takes to make them visible to every shader.
+class FrameConstantsBuffer
+{
+public:
+    // Constructor/Destructor
+    FrameConstantsBuffer();
+    ~FrameConstantsBuffer();
+    // Uploads this frame's constants
+    void Update(const FrameConstants &constants);
+private:
+    // Render state
+    GLuint UBO;
+};
+
+#endif
@@ -8,84 +8,84 @@
 ******************************************************************/
 #ifndef GAME_H
 #define GAME_H
-#include <vector>
-#include <tuple>
+
+#include <atomic>
+#include <chrono>
+#include <thread>
 
 #include <glad/glad.h>
 #include <GLFW/glfw3.h>
 
-#include "game_level.h"
-#include "power_up.h"
-
-// Represents the current state of the game
-enum GameState
-{
-   GAME_ACTIVE,
-   GAME_MENU,
-   GAME_WIN
-};
-
-// Represents the four possible (collision) directions
-// Joey made the mistake of inverting UP and DOWN
-enum Direction
-{
-    UP,    // (0.0f, 1.0f)
-    RIGHT, // (1.0f, 0.0f)
-    DOWN,  // (0.0f, -1.0f)
-    LEFT   // (-1.0f, 0.0f)
-};
-
-// 0) Did they collide?
-// 1) In what direction was the ball moving?
-// 2) Center of circle - closest point on AABB
-typedef std::tuple<GLboolean, Direction, glm::vec2> Collision;
+#include "game_simulation.h"
+#include "game_snapshot.h"
+#include "input_recording.h"
+#include "resource_manager.h"
+#include "triple_buffer.h"
 
-// Initial size of the player paddle
-const glm::vec2 PLAYER_SIZE(100, 20);
-// Initial velocity of the player paddle
-const GLfloat PLAYER_VELOCITY(500.0f);
-// Radius of the ball object
-const GLfloat BALL_RADIUS = 12.5f;
-// Initial velocity of the Ball
-const glm::vec2 INITIAL_BALL_VELOCITY(100.0f, -350.0f);
+// Number of MSAA samples the game is rendered with while a post-processing effect is enabled (0 disables MSAA)
+const GLuint  POSTPROCESSING_SAMPLES = 8;
+// Resolution the game is rendered at while a post-processing effect is enabled, relative to the window's
+const GLfloat POSTPROCESSING_SCALE = 1.0f;
+// Distance between the taps of the edge detection kernel the chaos effect applies, in window pixels
+const GLfloat EDGE_SPREAD = 2.5f;
+// Number of times per second the simulation (and the input) is updated, independently of the frame rate
+const GLuint  SIMULATION_TICK_RATE = 120;
+// Maximum number of ticks the simulation runs back to back to catch up after a stall, older ones are dropped
+const GLuint  MAX_CATCH_UP_TICKS = 5;
 
 // Game holds all game-related state and functionality.
 // Combines all game-related data into a single class for
 // easy access to each of the components and manageability.
+// The gameplay itself is run by the GameSimulation; Game
+// feeds it the player's input and presents its state.
+// Once started, the simulation runs at a fixed tick on its own thread
+// (ProcessInput and Update are called from there) and publishes a
+// GameSnapshot after every tick. Render draws the last two snapshots it
+// received, interpolated to the current time, and never waits for the
+// simulation. Both threads share the keys, and Render reads the geometry of
+// the levels (Simulation.Levels), which never changes once Init loaded them;
+// everything else it draws comes from the snapshots.
+// The keys of every tick can be recorded, to replay the game exactly
+// (and as fast as possible) with BreakoutSim.
 class Game
 {
 public:
     // Game state
-    GameState              State;
-    GLboolean              Keys[1024];
-    GLboolean              KeysProcessed[1024];
+    GameSimulation         Simulation;
+    std::atomic<GLboolean> Keys[1024];
+    std::atomic<GLboolean> KeysProcessed[1024];
     GLuint                 Width, Height;
-    std::vector<GameLevel> Levels;
-    GLuint                 Level;
-    std::vector<PowerUp>   PowerUps;
-    GLuint                 Lives;
 
     // Constructor/Destructor
     Game(GLuint width, GLuint height);
     ~Game();
 
-    // Initialize game state (load all shaders/textures/levels)
-    void Init();
+    // Initialize game state (load all shaders/textures/levels), progress is called while waiting for the textures
+    void Init(LoadProgressCallback progress = nullptr);
+
+    // Starts running the simulation on its own thread with a new seed, recording its input to the given file (if any)
+    void Start(const GLchar *recordFile = nullptr);
+    // Stops the simulation, and finishes the recording
+    void Stop();
 
-    // GameLoop
+    // GameLoop (ProcessInput and Update are run by the simulation thread once started)
     void ProcessInput(GLfloat dt);
     void Update(GLfloat dt);
     void Render();
-
-    void DoCollisions();
-
-    // Reset
-    void ResetLevel();
-    void ResetPlayer();
-
-    // Powerups
-    void SpawnPowerUps(GameObject &block);
-    void UpdatePowerUps(GLfloat dt);
+private:
+    // Simulation thread state
+    std::thread                simulationThread;
+    std::atomic<GLboolean>     running;
+    GLuint64                   tick;      // Number of the last tick that was run
+    TripleBuffer<GameSnapshot> snapshots; // Written by the simulation thread, read by Render
+    // The two most recent snapshots Render received, it draws in between them
+    GameSnapshot               previous, current;
+    // Records the keys of every tick (only used by the simulation thread while open)
+    InputRecorder              recorder;
+    // Runs the ticks as they become due until stopped
+    void runSimulation();
+    // Copies the state of the simulation that is drawn into a snapshot and publishes it
+    void publish(std::chrono::steady_clock::time_point time);
 };
 
 #endif
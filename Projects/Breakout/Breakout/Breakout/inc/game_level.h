@@ -14,28 +14,54 @@
 #include <glm/glm.hpp>
 
 #include "game_object.h"
-#include "sprite_renderer.h"
-#include "resource_manager.h"
+#include "level_format.h"
 
 
 // GameLevel holds all Tiles as part of a Breakout level and 
-// hosts functionality to Load/render levels from the harddisk.
+// hosts functionality to Load levels from the harddisk.
+// Levels are loaded from the compiled format (see level_format.h and levelc)
+// once; restarting a level only brings the destroyed bricks back (see Reset).
+// It is part of the simulation and doesn't render anything itself (see
+// LevelRenderer); it only records which bricks were destroyed, in order,
+// so the renderer can pick up the changes since it last drew the level.
 class GameLevel
 {
 public:
     // Level state
     std::vector<GameObject> Bricks;
+    // Grid dimensions (in tiles)
+    GLuint                  GridWidth, GridHeight;
+    // Grid cell of each brick
+    std::vector<GLuint>     BrickCells;
+    // Indices of the bricks destroyed since the level was loaded, in the order in which they were destroyed
+    std::vector<GLuint>     DestroyedBricks;
+    // Incremented every time the level is (re)loaded
+    GLuint                  Generation;
+    // Incremented every time the level is reset
+    GLuint                  Resets;
     // Constructor
-    GameLevel() { }
-    // Loads level from file
+    GameLevel();
+    // Loads level from a compiled level file
     void      Load(const GLchar *file, GLuint levelWidth, GLuint levelHeight);
-    // Render level
-    void      Draw(SpriteRenderer &renderer);
+    // Brings all destroyed bricks back, putting the level in the state it was loaded in (without touching the disk)
+    void      Reset();
+    // Destroys a brick, always use this instead of setting Destroyed directly so the brick disappears from the screen and the grid
+    void      DestroyBrick(GLuint index);
+    // Collects the indices of the bricks that are still alive in the grid cells overlapped by the given box (in ascending order)
+    void      QueryBricks(glm::vec2 min, glm::vec2 max, std::vector<GLuint> &bricks) const;
     // Check if the level is completed (all non-solid tiles are destroyed)
-    GLboolean IsCompleted();
+    GLboolean IsCompleted() const;
 private:
-    // Initialize level from tile data
-    void      init(std::vector<std::vector<GLuint>> tileData, GLuint levelWidth, GLuint levelHeight);
+    // Size of a tile
+    GLfloat unitWidth, unitHeight;
+    // Index of the live brick in each grid cell (-1 if the cell is empty), lets collision queries skip most bricks
+    std::vector<GLint> cellBricks;
+    // Number of non-solid bricks that are still alive
+    GLuint remainingBricks;
+    // Contents of the last loaded file (kept around so its storage is reused)
+    std::vector<GLubyte> fileData;
+    // Initialize level from the compiled tile grid and palette
+    void      init(const LevelFileHeader &header, const LevelPaletteEntry *palette, const GLubyte *tiles, GLuint levelWidth, GLuint levelHeight);
 };
 
 #endif
@@ -12,13 +12,12 @@
 #include <glad/glad.h>
 #include <glm/glm.hpp>
 
-#include "texture.h"
-#include "sprite_renderer.h"
-
 
 // Container object for holding all state relevant for a single
 // game object entity. Each object in the game likely needs the
 // minimal of state as described within GameObject.
+// Game objects are part of the simulation, so they hold no render state
+// at all; the Game decides which sprite each of them is drawn with.
 class GameObject
 {
 public:
@@ -29,19 +28,12 @@ public:
     GLboolean   IsSolid;
     GLboolean   Destroyed;
 
-    // Render state
-    Texture2D   Sprite;
-
     // Constructor(s)
     GameObject();
     GameObject(glm::vec2 pos,
                glm::vec2 size,
-               Texture2D sprite,
                glm::vec3 color = glm::vec3(1.0f),
                glm::vec2 velocity = glm::vec2(0.0f, 0.0f));
-
-    // Draw sprite
-    virtual void Draw(SpriteRenderer &renderer);
 };
 
 #endif
@@ -0,0 +1,200 @@
+/*******************************************************************
+** This code is part of Breakout.
+**
+** Breakout is free software: you can redistribute it and/or modify
+** it under the terms of the CC BY 4.0 license as published by
+** Creative Commons, either version 4 of the License, or (at your
+** option) any later version.
+******************************************************************/
+#ifndef GAME_SIMULATION_H
+#define GAME_SIMULATION_H
+#include <bitset>
+#include <vector>
+#include <tuple>
+
+#include <glad/glad.h>
+#include <glm/glm.hpp>
+
+#include "game_level.h"
+#include "game_object.h"
+#include "power_up.h"
+#include "random.h"
+
+// Represents the current state of the game
+enum GameState
+{
+   GAME_ACTIVE,
+   GAME_MENU,
+   GAME_WIN
+};
+
+// The keys the simulation reacts to, whatever they are bound to on the keyboard (see Game::ProcessInput)
+enum SimulationKey
+{
+    KEY_CONFIRM,        // Starts the game in the menu, goes back to the menu after a win
+    KEY_NEXT_LEVEL,
+    KEY_PREVIOUS_LEVEL,
+    KEY_LEFT,
+    KEY_RIGHT,
+    KEY_LAUNCH,
+    NUM_KEYS
+};
+// Which keys are held down, by SimulationKey, as sampled once per update
+typedef std::bitset<NUM_KEYS> KeyState;
+
+// Represents the four possible (collision) directions
+// Joey made the mistake of inverting UP and DOWN
+enum Direction
+{
+    UP,    // (0.0f, 1.0f)
+    RIGHT, // (1.0f, 0.0f)
+    DOWN,  // (0.0f, -1.0f)
+    LEFT   // (-1.0f, 0.0f)
+};
+
+// 0) Did they collide?
+// 1) In what direction was the ball moving?
+// 2) Center of circle - closest point on AABB
+typedef std::tuple<GLboolean, Direction, glm::vec2> Collision;
+
+// 0) Did they collide?
+// 1) Time of impact, as a fraction of the motion
+// 2) Normal of the surface that was hit (pointing towards the ball)
+typedef std::tuple<GLboolean, GLfloat, glm::vec2> SweptCollision;
+
+// Something that happened during an update that the presentation may want to react to (sounds, effects...)
+enum SimulationEventType
+{
+    BRICK_DESTROYED,
+    SOLID_BRICK_HIT,
+    PADDLE_HIT,
+    POWERUP_ACTIVATED
+};
+
+struct SimulationEvent
+{
+    SimulationEventType Type;
+    glm::vec2           Position; // Where it happened
+};
+
+// Initial size of the player paddle
+const glm::vec2 PLAYER_SIZE(100, 20);
+// Initial velocity of the player paddle
+const GLfloat PLAYER_VELOCITY(500.0f);
+// Radius of the ball object
+const GLfloat BALL_RADIUS = 12.5f;
+// Initial velocity of the Ball
+const glm::vec2 INITIAL_BALL_VELOCITY(100.0f, -350.0f);
+// Maximum number of collisions a ball resolves per update (the rest of its motion is dropped)
+const GLuint MAX_BALL_COLLISIONS = 8;
+// Maximum number of balls in play at once
+const GLuint MAX_BALLS = 512;
+// Number of balls each ball in play splits off when the split powerup is activated
+const GLuint SPLIT_BALLS = 2;
+// Number of lives at the start of a game
+const GLuint INITIAL_LIVES = 3;
+
+// Holds the state of all balls in play as separate arrays (structure of arrays).
+// All balls share the same radius and powerup state, which is kept by the GameSimulation.
+struct BallPool
+{
+    std::vector<glm::vec2> Positions;  // Top left corner of each ball
+    std::vector<glm::vec2> Velocities;
+    std::vector<GLubyte>   Stuck;      // Whether the ball sits on the paddle
+
+    GLuint Count() const { return this->Positions.size(); }
+    void   Clear() { this->Positions.clear(); this->Velocities.clear(); this->Stuck.clear(); }
+    void   Add(glm::vec2 position, glm::vec2 velocity, GLboolean stuck)
+    {
+        this->Positions.push_back(position);
+        this->Velocities.push_back(velocity);
+        this->Stuck.push_back(stuck);
+    }
+};
+
+// The first thing a ball runs into along its motion
+struct BallHit
+{
+    GLfloat   Time;    // Fraction of the motion after which it hits (1 if nothing is hit)
+    glm::vec2 Normal;  // Normal of the surface that was hit
+    GLint     Brick;   // Index of the brick that was hit, or -1
+    GLboolean Hit, Player;
+};
+
+// GameSimulation holds the complete gameplay state of a game of Breakout
+// and advances it. It doesn't touch OpenGL, the window or the audio device,
+// so it can be ticked without any of them (see the BreakoutSim project).
+// Whatever should be seen or heard is left to the caller, which reads the
+// state after each update and reacts to the Events it produced.
+// Given the same seed, the same keys and the same time steps, it always
+// plays out the same way (see InputRecorder and InputReplayer).
+class GameSimulation
+{
+public:
+    // Game state
+    GameState              State;
+    GLuint                 Width, Height;
+    std::vector<GameLevel> Levels;
+    GLuint                 Level;
+    std::vector<PowerUp>   PowerUps;     // Falling and active PowerUps (never holds more than MAX_POWERUPS, so it never reallocates)
+    std::vector<PowerUpDefinition> PowerUpTypes; // Indexed by PowerUpType
+    GLuint                 Lives;
+    GameObject             Player;
+    BallPool               Balls;
+    // State shared by all balls
+    glm::vec3              BallColor;
+    GLboolean              Sticky, PassThrough;
+    // Active effects (shown by the post-processor when rendering)
+    GLboolean              Confuse, Chaos, Shake;
+    GLfloat                ShakeTime;
+    // What happened during the last update
+    std::vector<SimulationEvent> Events;
+    // All randomness of the gameplay (which PowerUps spawn) is drawn from here, seed it to reproduce a game
+    Random                 RNG;
+
+    // Constructor
+    GameSimulation(GLuint width, GLuint height);
+
+    // Loads the levels and the PowerUp definitions and places the player and ball
+    void Init();
+
+    // Input
+    void ProcessInput(const KeyState &keys, GLfloat dt); // Reacts to the keys held down in this update, and the ones pressed since the last
+    void MovePlayer(GLfloat direction, GLfloat dt); // Direction is -1 (left) to 1 (right)
+    void LaunchBalls();
+
+    // Advances the game by dt seconds
+    void Update(GLfloat dt);
+
+    // Reset
+    void ResetLevel();
+    void ResetPlayer();
+
+    // Hash of the complete gameplay state, equal hashes after replaying the same input mean the game played out the same way
+    GLuint64 StateHash() const;
+private:
+    // Keys that were held down in the last call to ProcessInput
+    KeyState previousKeys;
+    // Scratch state of MoveBalls (kept around so its storage is reused)
+    std::vector<GLfloat> ballTimeLeft; // Time each ball still has to move this update
+    std::vector<GLuint>  movingBalls;  // Balls that still have to move in the current pass
+    std::vector<BallHit> ballHits;     // Earliest hit of each moving ball in the current pass
+    std::vector<GLuint>  nearbyBricks; // Bricks near the ball whose hit is being found
+    // Moves all balls along their paths, bouncing them off everything they run into on the way
+    void MoveBalls(GLfloat dt);
+    // Finds the first thing a ball runs into when it moves for the given time (only reads state)
+    BallHit FindBallHit(GLuint ball, GLfloat time, std::vector<GLuint> &nearbyBricks) const;
+    // Bounces a ball that was moved up to what it hit off of it
+    void ResolveBallHit(GLuint ball, const BallHit &hit);
+    // Removes the balls that fell off the bottom of the screen
+    void RemoveLostBalls();
+    void DoCollisions();
+
+    // Powerups
+    GLuint activeEffects[NUM_POWERUP_TYPES]; // Number of active PowerUps of each type, an effect ends when its count drops to 0
+    void SpawnPowerUps(GameObject &block);
+    void ActivatePowerUp(PowerUp &powerUp);
+    void UpdatePowerUps(GLfloat dt);
+};
+
+#endif
@@ -0,0 +1,56 @@
+/*******************************************************************
+** This code is part of Breakout.
+**
+** Breakout is free software: you can redistribute it and/or modify
+** it under the terms of the CC BY 4.0 license as published by
+** Creative Commons, either version 4 of the License, or (at your
+** option) any later version.
+******************************************************************/
+#ifndef GAME_SNAPSHOT_H
+#define GAME_SNAPSHOT_H
+#include <chrono>
+#include <vector>
+
+#include <glad/glad.h>
+#include <glm/glm.hpp>
+
+#include "game_simulation.h"
+#include "power_up.h"
+
+
+// Where and how an object is drawn
+struct ObjectSnapshot
+{
+    glm::vec2   Position, Size;
+    GLfloat     Rotation;
+    glm::vec3   Color;
+    PowerUpType Type; // Only used by PowerUps
+};
+
+// Everything the Game draws of the simulation as it was after one tick.
+// Snapshots are filled in by the simulation thread and never change once they
+// are published, so the render thread can read them while the next tick runs.
+// They are reused from tick to tick, so their arrays only allocate while they grow.
+// The destroyed bricks of the level only ever grow until it is restarted, so each
+// snapshot holds all of them and a reader that skipped snapshots misses nothing,
+// yet the writer only appends the bricks destroyed since it last filled the slot.
+struct GameSnapshot
+{
+    GLuint64                              Tick;      // Number of the tick (0 for a snapshot that was never filled in)
+    std::chrono::steady_clock::time_point Time;      // When the tick was due
+    GameState                             State;
+    GLuint                                Level, Lives;
+    GLuint                                LevelGeneration, LevelResets; // Of the level when the tick ended, DestroyedCells starts over when either changes
+    std::vector<GLuint>                   DestroyedCells; // Grid cells of the bricks destroyed since the level was (re)started, in order
+    ObjectSnapshot                        Player;
+    std::vector<glm::vec2>                Balls;     // Positions
+    glm::vec3                             BallColor;
+    std::vector<ObjectSnapshot>           PowerUps;  // Only the ones that are still falling
+    std::vector<glm::vec2>                ParticlePositions;
+    std::vector<glm::vec4>                ParticleColors;
+    GLboolean                             Confuse, Chaos, Shake;
+
+    GameSnapshot() : Tick(0), State(GAME_MENU), Level(0), Lives(0), LevelGeneration(0), LevelResets(0), Player(), BallColor(1.0f), Confuse(), Chaos(), Shake() { }
+};
+
+#endif
@@ -0,0 +1,71 @@
+/*******************************************************************
+** This code is part of Breakout.
+**
+** Breakout is free software: you can redistribute it and/or modify
+** it under the terms of the CC BY 4.0 license as published by
+** Creative Commons, either version 4 of the License, or (at your
+** option) any later version.
+******************************************************************/
+#ifndef GL_STATE_H
+#define GL_STATE_H
+
+#include <glad/glad.h>
+
+
+// Number of texture units whose bindings are tracked
+const GLuint MAX_TRACKED_TEXTURE_UNITS = 16;
+
+// A static singleton GLState class that shadows the pieces of OpenGL state
+// that the renderers change all the time: the bound program, vertex array,
+// 2D texture per unit, blend function and the blend/depth test/face culling
+// capabilities. Calls that would not change anything are never forwarded
+// to the driver. All of Breakout's state changes must go through GLState,
+// otherwise the shadow copy goes stale (call Invalidate() if that happens).
+class GLState
+{
+public:
+    // Number of calls per kind of state change
+    struct Counters
+    {
+        GLuint Programs;
+        GLuint VertexArrays;
+        GLuint ActiveTextures;
+        GLuint Textures;
+        GLuint BlendFuncs;
+        GLuint Capabilities;
+
+        GLuint Total() const { return this->Programs + this->VertexArrays + this->ActiveTextures + this->Textures + this->BlendFuncs + this->Capabilities; }
+    };
+    // Calls that were forwarded to the driver and calls that were elided since the last ResetCounters()
+    static Counters Issued, Skipped;
+    // State changes
+    static void UseProgram(GLuint program);
+    static void BindVertexArray(GLuint vertexArray);
+    static void ActiveTexture(GLuint unit); // Takes the index of the unit, not GL_TEXTURE0 + index
+    static void BindTexture(GLuint texture); // Binds a GL_TEXTURE_2D texture to the active unit
+    static void BlendFunc(GLenum sourceFactor, GLenum destinationFactor);
+    static void Enable(GLenum capability);
+    static void Disable(GLenum capability);
+    // Deleting a bound object resets its binding to 0, so deletions must go through here as well
+    static void DeleteProgram(GLuint program);
+    static void DeleteVertexArray(GLuint vertexArray);
+    static void DeleteTexture(GLuint texture);
+    // Forgets everything, so the next call of each kind is always forwarded
+    static void Invalidate();
+    // Sets all counters back to 0
+    static void ResetCounters();
+private:
+    // Private constructor, that is we do not want any actual GLState objects. Its members and functions should be publicly available (static).
+    GLState() { }
+    // Shadowed state (UNKNOWN_STATE when it isn't known)
+    static GLuint program;
+    static GLuint vertexArray;
+    static GLuint activeUnit;
+    static GLuint textures[MAX_TRACKED_TEXTURE_UNITS];
+    static GLenum blendSource, blendDestination;
+    static GLuint capabilities[3]; // GL_BLEND, GL_DEPTH_TEST and GL_CULL_FACE
+    // Enables or disables a capability, if needed
+    static void setCapability(GLenum capability, GLboolean enabled);
+};
+
+#endif
@@ -0,0 +1,47 @@
+/*******************************************************************
+** This code is part of Breakout.
+**
+** Breakout is free software: you can redistribute it and/or modify
+** it under the terms of the CC BY 4.0 license as published by
+** Creative Commons, either version 4 of the License, or (at your
+** option) any later version.
+******************************************************************/
+#ifndef GPU_TIMER_H
+#define GPU_TIMER_H
+
+#include <glad/glad.h>
+
+#include "profiler.h"
+
+
+// Number of frames a GPUTimer's queries can be in flight before it skips a frame
+const GLuint GPU_TIMER_QUERIES = 4;
+
+// GPUTimer measures how long the GPU spends on the commands issued between
+// Begin() and End() with GL_TIME_ELAPSED queries and reports it to the Profiler.
+// The queries are used as a ring: a result is only read once the GPU says it
+// is available, and recorded for the frame it was issued in, so the CPU never
+// waits for the GPU. If all queries are still in flight that frame isn't timed.
+// Only one GPUTimer can be timing at once (GL_TIME_ELAPSED queries can't nest).
+class GPUTimer
+{
+public:
+    // Constructor (the zone the times are recorded in)
+    GPUTimer(ProfileZone zone);
+    // Destructor
+    ~GPUTimer();
+    // Starts and stops timing, at most once per frame
+    void Begin();
+    void End();
+private:
+    ProfileZone zone;
+    GLuint      queries[GPU_TIMER_QUERIES];
+    GLuint64    frames[GPU_TIMER_QUERIES];  // Frame each query was issued in
+    GLboolean   pending[GPU_TIMER_QUERIES]; // Whether the result of each query is yet to be read
+    GLuint      next;                       // Query to issue next
+    GLboolean   timing;
+    // Records the results of the queries that became available
+    void collect();
+};
+
+#endif
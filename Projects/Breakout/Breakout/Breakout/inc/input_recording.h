@@ -0,0 +1,100 @@
+/*******************************************************************
+** This code is part of Breakout.
+**
+** Breakout is free software: you can redistribute it and/or modify
+** it under the terms of the CC BY 4.0 license as published by
+** Creative Commons, either version 4 of the License, or (at your
+** option) any later version.
+******************************************************************/
+#ifndef INPUT_RECORDING_H
+#define INPUT_RECORDING_H
+#include <fstream>
+#include <vector>
+
+#include <glad/glad.h>
+
+#include "game_simulation.h"
+
+
+// Layout of the input recordings (.brec) written by InputRecorder and read by InputReplayer.
+// A GameSimulation is deterministic, so its seed, its starting level and the keys of every
+// tick are all it takes to play a game out again exactly. Only the keys that went up or
+// down are stored, so a recording takes a few bytes per key press. All values are stored
+// little-endian, numbers in the events as LEB128 varints (7 bits per byte, low bits first).
+//
+// File layout:
+//   RecordingHeader
+//   Events, one per key that changed:
+//     varint   Ticks since the previous event (or since the start)
+//     varint   SimulationKey << 1, plus 1 if the key went down (RECORDING_END after the last tick)
+//   GLuint64   StateHash() of the simulation after the last tick
+
+// Identifies an input recording
+const GLchar RECORDING_MAGIC[4] = { 'B', 'R', 'E', 'C' };
+// Incremented whenever the layout changes
+const GLuint RECORDING_VERSION = 2;
+// Key event marking the end of the recording, its tick is the last tick
+const GLuint RECORDING_END = NUM_KEYS << 1;
+
+struct RecordingHeader
+{
+    GLchar   Magic[4];
+    GLuint   Version;
+    GLuint64 Seed;      // The simulation's RNG was seeded with this
+    GLuint   TickRate;  // Updates per second, each advanced the simulation by 1 / TickRate seconds
+    GLuint   Level;     // Level that was selected when the recording started (in the menu)
+};
+
+
+// Writes the keys of every tick of a game to an input recording
+class InputRecorder
+{
+public:
+    // Constructor
+    InputRecorder();
+    // Starts a recording of a simulation that was seeded with the given seed and is about to be updated for the first time
+    GLboolean Open(const GLchar *file, GLuint64 seed, GLuint tickRate, GLuint level);
+    GLboolean IsOpen() const;
+    // Records the keys of the next tick (only the ones that changed since the last tick are written)
+    void      Record(const KeyState &keys);
+    // Finishes the recording with the hash of the simulation's state after the last recorded tick
+    GLboolean Close(GLuint64 stateHash);
+    // Number of ticks that were recorded
+    GLuint64  Ticks() const;
+private:
+    std::ofstream file;
+    KeyState      keys;      // Keys of the last recorded tick
+    GLuint64      ticks;
+    GLuint64      lastEvent; // Tick of the last written event
+    // Writes a key event at the current tick
+    void writeEvent(GLuint key);
+    void writeVarint(GLuint64 value);
+};
+
+// Reads an input recording back, tick by tick
+class InputReplayer
+{
+public:
+    // What the recording was made of, valid once opened
+    RecordingHeader Header;
+    GLuint64        Ticks;
+    GLuint64        StateHash;
+    // Constructor
+    InputReplayer();
+    // Reads a whole recording into memory and checks that it is complete, returns GL_FALSE if it can't be replayed
+    GLboolean Open(const GLchar *file);
+    // Gets the keys of the next tick, returns GL_FALSE once all recorded ticks were replayed
+    GLboolean Next(KeyState &keys);
+private:
+    std::vector<GLubyte> data;
+    size_t               cursor;    // Position of the next event in data
+    KeyState             keys;      // Keys of the last replayed tick
+    GLuint64             tick;      // Number of ticks replayed
+    GLuint64             nextTick;  // Tick of the next event
+    GLuint64             nextKey;   // SimulationKey and direction of the next event
+    // Reads the next event, returns GL_FALSE if the data ends in the middle of it
+    GLboolean readEvent();
+    GLboolean readVarint(GLuint64 &value);
+};
+
+#endif
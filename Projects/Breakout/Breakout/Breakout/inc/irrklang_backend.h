@@ -0,0 +1,39 @@
+/*******************************************************************
+** This code is part of Breakout.
+**
+** Breakout is free software: you can redistribute it and/or modify
+** it under the terms of the CC BY 4.0 license as published by
+** Creative Commons, either version 4 of the License, or (at your
+** option) any later version.
+******************************************************************/
+#ifndef IRRKLANG_BACKEND_H
+#define IRRKLANG_BACKEND_H
+
+#include <vector>
+
+#include <irrklang/irrKlang.h>
+
+#include "audio_player.h"
+
+
+// Plays an AudioPlayer's sounds through irrKlang. Sounds that aren't streamed
+// are decoded into memory when they are loaded, so starting them is cheap.
+class IrrKlangBackend : public AudioBackend
+{
+public:
+    // Constructor (takes over the reference to the engine)
+    IrrKlangBackend(irrklang::ISoundEngine *engine);
+    // Destructor
+    ~IrrKlangBackend();
+    // AudioBackend
+    GLboolean Load(SoundHandle sound, const GLchar *file, GLboolean stream);
+    GLboolean Play(GLuint voice, SoundHandle sound, GLboolean loop);
+    GLboolean IsFinished(GLuint voice);
+    void      Release(GLuint voice);
+private:
+    irrklang::ISoundEngine *             engine;
+    std::vector<irrklang::ISoundSource*> sources;             // Indexed by SoundHandle
+    irrklang::ISound *                   voices[MAX_VOICES];  // Sound playing on each voice
+};
+
+#endif
@@ -0,0 +1,48 @@
+/*******************************************************************
+** This code is part of Breakout.
+**
+** Breakout is free software: you can redistribute it and/or modify
+** it under the terms of the CC BY 4.0 license as published by
+** Creative Commons, either version 4 of the License, or (at your
+** option) any later version.
+******************************************************************/
+#ifndef LEVEL_FORMAT_H
+#define LEVEL_FORMAT_H
+
+#include <glad/glad.h>
+#include <glm/glm.hpp>
+
+// Layout of the compiled (.blvl) level files written by levelc and read by GameLevel::Load.
+// Levels are authored as text (.lvl) and compiled offline, so loading them is a single read
+// followed by one pass over the tiles. All values are stored little-endian.
+//
+// File layout:
+//   LevelFileHeader
+//   LevelPaletteEntry[NumColors]
+//   GLubyte[Width * Height]       Tiles, row by row. 0 is an empty tile, any other value t
+//                                 is a brick that looks like palette entry t - 1
+
+// Identifies a compiled level file
+const GLchar LEVEL_FILE_MAGIC[4] = { 'B', 'L', 'V', 'L' };
+// Incremented whenever the layout changes
+const GLuint LEVEL_FILE_VERSION = 1;
+// Maximum number of palette entries (tiles are single bytes)
+const GLuint MAX_LEVEL_COLORS = 255;
+
+struct LevelFileHeader
+{
+    GLchar Magic[4];
+    GLuint Version;
+    GLuint Width, Height; // In tiles
+    GLuint NumColors;     // Number of palette entries
+    GLuint NumBricks;     // Number of non-empty tiles
+};
+
+// How the bricks of a tile type look and behave
+struct LevelPaletteEntry
+{
+    glm::vec3 Color;
+    GLuint    Solid;      // Solid bricks can't be destroyed
+};
+
+#endif
@@ -0,0 +1,69 @@
+/*******************************************************************
+** This code is part of Breakout.
+**
+** Breakout is free software: you can redistribute it and/or modify
+** it under the terms of the CC BY 4.0 license as published by
+** Creative Commons, either version 4 of the License, or (at your
+** option) any later version.
+******************************************************************/
+#ifndef LEVEL_RENDERER_H
+#define LEVEL_RENDERER_H
+#include <vector>
+
+#include <glad/glad.h>
+#include <glm/glm.hpp>
+
+#include "game_level.h"
+#include "shader.h"
+#include "texture_atlas.h"
+
+
+// Vertex of the baked brick geometry
+struct BrickVertex
+{
+    glm::vec2 Position;
+    glm::vec2 TexCoords;
+    glm::vec3 Color;
+    glm::vec2 Cell;      // Grid cell of the brick, used to look up whether it is still alive
+};
+
+
+// LevelRenderer draws the bricks of a GameLevel.
+// Bricks never move, so their quads are baked into a static vertex buffer
+// once per load. Whether a brick is still alive is stored in a texture with
+// one byte per grid cell that the vertex shader reads, so the whole level is
+// drawn with a single draw call. The destroyed bricks are passed in separately
+// from the level (see GameSnapshot), so only the level's geometry is read, and
+// only the texels of the bricks destroyed since the last call are uploaded.
+class LevelRenderer
+{
+public:
+    // Constructor (both sprites must be packed into the same texture)
+    LevelRenderer(const Shader &shader, const SpriteRegion &block, const SpriteRegion &solidBlock);
+    // Destructor
+    ~LevelRenderer();
+    // Renders the level with the given cells destroyed since it was reset for the given time (one draw call for all bricks)
+    void Draw(const GameLevel &level, GLuint resets, const std::vector<GLuint> &destroyedCells);
+private:
+    // Render state
+    Shader       shader;
+    SpriteRegion block, solidBlock;
+    GLuint       VAO, VBO;
+    GLuint       livenessTexture;
+    GLuint       numVertices;
+    // The level that is currently uploaded
+    const GameLevel *level;
+    GLuint           generation;        // Generation of the level when it was baked
+    GLuint           resets;            // Resets of the level as last uploaded
+    GLuint           numDestroyed;      // Number of destroyed cells that are uploaded
+    // Liveness of all cells (255 if they hold a live brick), only used to upload the whole texture at once
+    std::vector<GLubyte> liveness;
+    // Initializes the vertex buffer and the liveness texture
+    void initRenderData();
+    // Bakes the geometry of all bricks
+    void bake(const GameLevel &level);
+    // Uploads the liveness of all cells
+    void upload(const GameLevel &level, const std::vector<GLuint> &destroyedCells);
+};
+
+#endif
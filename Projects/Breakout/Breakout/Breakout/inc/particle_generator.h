@@ -15,45 +15,67 @@
 
 #include "shader.h"
 #include "texture.h"
+#include "texture_atlas.h"
 #include "game_object.h"
+#include "random.h"
 
 
-// Represents a single particle and its state
-struct Particle {
-    glm::vec2 Position, Velocity;
-    glm::vec4 Color;
-    GLfloat Life;
+// Holds the state of all the particles of a generator as separate arrays (structure of arrays),
+// so the update loop streams through tightly packed floats and can be vectorized.
+// The live particles are always compacted into [0, NumAlive) and the dead ones into [NumAlive, capacity).
+struct ParticlePool {
+    std::vector<glm::vec2> Positions;
+    std::vector<glm::vec2> Velocities;
+    std::vector<glm::vec4> Colors;
+    std::vector<GLfloat>   Life;
+    GLuint                 NumAlive;
 
-    Particle() : Position(0.0f), Velocity(0.0f), Color(1.0f), Life(0.0f) { }
+    ParticlePool() : NumAlive(0) { }
 };
 
+// Number of frames worth of particle data the streaming buffer holds, so that the CPU
+// never writes into a region of the buffer that the GPU may still be reading from
+const GLuint PARTICLE_BUFFER_REGIONS = 3;
+
 
 // ParticleGenerator acts as a container for rendering a large number of 
 // particles by repeatedly spawning and updating particles and killing 
 // them after a given amount of time.
+// Spawning and updating make no GL calls and may run on another thread than
+// drawing; Draw() is handed the particles to render (a copy of the pool, see
+// GameSnapshot) rather than reading the pool itself.
 class ParticleGenerator
 {
 public:
     // Constructor
-    ParticleGenerator(Shader shader, Texture2D texture, GLuint numParticles);
-    // Update all particles
+    ParticleGenerator(Shader shader, SpriteRegion sprite, GLuint numParticles);
+    // Spawns new particles at the given object and updates all live particles
     void Update(GLfloat dt, GameObject &object, GLuint newParticles, glm::vec2 offsetFromTarget = glm::vec2(0.0f, 0.0f));
-    // Render all particles
-    void Draw();
+    // Spawns new particles at the given position, trailing the given velocity (particles that don't fit in the pool are dropped)
+    void Emit(glm::vec2 position, glm::vec2 velocity, GLuint newParticles, glm::vec2 offsetFromTarget = glm::vec2(0.0f, 0.0f));
+    // Ages, kills and moves all live particles
+    void Update(GLfloat dt);
+    // The particles that are simulated
+    const ParticlePool & GetParticles() const;
+    // Render the given particles with a single instanced draw call (at most as many as the pool holds)
+    void Draw(const glm::vec2 *positions, const glm::vec4 *colors, GLuint count);
 private:
     // State
-    std::vector<Particle> particles;
+    ParticlePool particles;
     GLuint numParticles;
+    Random rng;      // Particles are only for show, so they don't draw from the simulation's generator
     // Render state
     Shader shader;
-    Texture2D texture;
+    GLint  texRectLocation;
+    SpriteRegion sprite;
     GLuint VAO;
+    GLuint instanceVBO;                             // Ring buffer of PARTICLE_BUFFER_REGIONS regions, each holding numParticles positions followed by numParticles colors
+    GLuint bufferRegion;                            // Region of the ring buffer the next Draw writes to
+    GLsync regionFences[PARTICLE_BUFFER_REGIONS];   // Signaled once the GPU is done drawing from a region
     // Initializes buffer and vertex attributes
     void init();
-    // Returns the first Particle index that's currently unused e.g. Life <= 0.0f or 0 if no particle is currently inactive
-    GLuint firstUnusedParticle();
-    // Respawns particle
-    void respawnParticle(Particle &particle, GameObject &object, glm::vec2 offsetFromTarget = glm::vec2(0.0f, 0.0f));
+    // Respawns the particle at the given index
+    void respawnParticle(GLuint index, glm::vec2 position, glm::vec2 velocity, glm::vec2 offsetFromTarget = glm::vec2(0.0f, 0.0f));
 };
 
 #endif
@@ -9,6 +9,8 @@
 #ifndef POST_PROCESSOR_H
 #define POST_PROCESSOR_H
 
+#include <vector>
+
 #include <glad/glad.h>
 #include <glm/glm.hpp>
 
@@ -16,33 +18,94 @@
 #include "sprite_renderer.h"
 #include "shader.h"
 
+// A render target of the effect graph, pooled by the PostProcessor
+struct PostTarget
+{
+    GLuint    FBO;
+    Texture2D Texture;
+    GLuint    Version; // Incremented every time something is rendered into it
+};
+
+// A full-screen pass of the PostProcessor's effect graph. The enabled passes run in the
+// order in which they were added, each one reading the output of the enabled pass before
+// it (the rendered game for the first one). The shader gets its input as the sampler
+// scene and the distance between its kernel's taps (Step, converted to texture coordinates) as step.
+class PostPass
+{
+public:
+    // Pass settings
+    Shader    PassShader;
+    GLfloat   Scale;   // Size of its output relative to the resolution the game is rendered at
+    glm::vec2 Step;    // Distance between the taps of its kernel, in texels of its input
+    GLboolean Enabled;
+    GLuint    Version; // Increment after changing the pass' settings or uniforms, passes whose input and version didn't change are skipped
+    // Constructor
+    PostPass(Shader shader, GLfloat scale, glm::vec2 step);
+private:
+    friend class PostProcessor;
+    // What the pass rendered the last time it ran, so it can tell whether its output is still up to date
+    GLint  target;        // Index of the pooled target it rendered into (-1 if it never ran)
+    GLint  inputTarget;   // Index of the pooled target it read (-1 for the rendered game)
+    GLuint inputVersion, version, targetVersion;
+    // Location of the shader's step uniform (looked up once by AddPass)
+    GLint  stepLocation;
+};
+
 // PostProcessor hosts all PostProcessing effects for the Breakout Game.
 // It renders the game on a textured quad after which one can enable specific effects by enabling the Confuse, Chaos or Shake booleans. 
+// The options are handed to the shader through the per-frame FrameConstants, so they must be uploaded before calling Render().
 // It is required to call BeginRender() before rendering the game and EndRender() after rendering the game for the class to work.
+// The effects that need kernels are passes of a small effect graph (see PostPass) that run
+// at the end of EndRender(); Render() then draws the output of the last one with the options applied.
+// The passes render into a pool of targets that are shared among all passes of the same size
+// (two per size are enough to ping-pong between them).
+// While no effect is enabled the game is rendered straight into the default framebuffer (which
+// the caller clears) and EndRender()/Render() do nothing; the path is picked once per frame by BeginRender().
 class PostProcessor
 {
 public:
     // State
     Shader PostProcessingShader;
     Texture2D Texture;
-    GLuint Width, Height;
+    GLuint Width, Height;             // Size of the default framebuffer
+    GLuint RenderWidth, RenderHeight; // Size the game is rendered at while effects are enabled
+    GLuint Samples;                   // Number of MSAA samples the game is rendered with while effects are enabled (0 for none)
     // Options
     GLboolean Confuse, Chaos, Shake;
-    // Constructor
-    PostProcessor(Shader shader, GLuint width, GLuint height);
+    // Effect graph
+    std::vector<PostPass> Passes;
+    // Constructor (the render target is renderScale times the size of the default framebuffer)
+    PostProcessor(Shader shader, GLuint width, GLuint height, GLuint samples = 8, GLfloat renderScale = 1.0f);
+    // Destructor
+    ~PostProcessor();
+    // Adds a pass to the end of the effect graph (enabled) and returns its index in Passes
+    GLuint AddPass(Shader shader, GLfloat scale = 1.0f, glm::vec2 step = glm::vec2(1.0f));
+    // Whether any effect or pass is enabled
+    GLboolean IsActive() const;
     // Prepares the postprocessor's framebuffer operations before rendering the game
     void BeginRender();
     // Should be called after rendering the game, so it stores all the rendered data into a texture object
     void EndRender();
     // Renders the PostProcessor texture quad (as a screen-encompassing large sprite)
-    void Render(GLfloat time);
+    void Render();
 private:
     // Render state
-    GLuint MSFBO, FBO; // MSFBO = Multisampled FBO. FBO is regular, used for blitting MS color-buffer to texture
+    GLuint MSFBO, FBO; // MSFBO = Multisampled FBO. FBO is regular, used for blitting MS color-buffer to texture (the game is rendered into it directly without MSAA)
     GLuint RBO; // RBO is used for multisampled color buffer
-    GLuint VAO;
+    GLuint VAO, VBO;
+    // Whether the current frame is rendered through the effects
+    GLboolean rendering;
+    // Incremented every time the game is rendered into Texture
+    GLuint sceneVersion;
+    // Pool of render targets of the passes, and the one holding the output of the last pass (-1 for Texture)
+    std::vector<PostTarget> targets;
+    GLint  output;
     // Initialize quad for rendering postprocessing texture
     void initRenderData();
+    // Runs the enabled passes
+    void runPasses();
+    // Returns a pooled target of the given size, other than the one being read
+    GLint  acquireTarget(GLuint width, GLuint height, GLint input);
 };
 
 #endif
@@ -9,6 +9,7 @@
 #ifndef POWER_UP_H
 #define POWER_UP_H
 #include <string>
+#include <vector>
 
 #include <glad/glad.h>
 #include <glm/glm.hpp>
@@ -20,27 +21,61 @@
 const glm::vec2 POWERUP_SIZE(60, 20);
 // Velocity a PowerUp block has when spawned
 const glm::vec2 VELOCITY(0.0f, 150.0f);
+// Maximum number of PowerUps that can be falling or active at once (more spawns are dropped)
+const GLuint MAX_POWERUPS = 64;
 
 
-// PowerUp inherits its state and rendering functions from
-// GameObject but also holds extra information to state its
-// active duration and whether it is activated or not.
-// The type of PowerUp is stored as a string.
+// Every kind of PowerUp, in the order in which their spawn chances are rolled
+enum PowerUpType : GLubyte
+{
+    POWERUP_SPEED,
+    POWERUP_STICKY,
+    POWERUP_PASS_THROUGH,
+    POWERUP_PAD_SIZE_INCREASE,
+    POWERUP_SPLIT,
+    POWERUP_CONFUSE,
+    POWERUP_CHAOS,
+    NUM_POWERUP_TYPES
+};
+
+// Describes one kind of PowerUp, as loaded from the PowerUp definitions file
+struct PowerUpDefinition
+{
+    std::string Name;     // Name used in the definitions file
+    GLuint      Chance;   // 1 in Chance bricks spawns one when destroyed (0 never spawns)
+    GLfloat     Duration; // Seconds the effect lasts (0 for instant effects)
+    glm::vec3   Color;
+    std::string Sprite;   // Name of the sprite it is drawn with
+
+    PowerUpDefinition() : Chance(0), Duration(0.0f), Color(1.0f) { }
+};
+
+
+// PowerUp inherits its state from GameObject but also holds
+// extra information to state its active duration and whether
+// it is activated or not.
 class PowerUp : public GameObject
 {
 public:
     // PowerUp State
-    std::string Type;
+    PowerUpType Type;
     GLfloat     Duration;
     GLboolean   Activated;
 
     // Constructor
-    PowerUp(std::string type, glm::vec3 color, GLfloat duration, glm::vec2 position, Texture2D texture) 
-        : GameObject(position, POWERUP_SIZE, texture, color, VELOCITY),
+    PowerUp(PowerUpType type, glm::vec3 color, GLfloat duration, glm::vec2 position)
+        : GameObject(position, POWERUP_SIZE, color, VELOCITY),
           Type(type),
           Duration(duration),
           Activated()
     { }
 };
 
+// Returns the name of a PowerUp type as used in the definitions file
+const GLchar * PowerUpName(PowerUpType type);
+// Loads the definitions of all PowerUp types from a file, one line per type:
+// <name> <chance> <duration> <r> <g> <b> <sprite>
+// Types that are missing from the file never spawn
+std::vector<PowerUpDefinition> LoadPowerUpDefinitions(const GLchar *file);
+
 #endif
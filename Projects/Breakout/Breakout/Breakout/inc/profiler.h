@@ -0,0 +1,93 @@
+/*******************************************************************
+** This code is part of Breakout.
+**
+** Breakout is free software: you can redistribute it and/or modify
+** it under the terms of the CC BY 4.0 license as published by
+** Creative Commons, either version 4 of the License, or (at your
+** option) any later version.
+******************************************************************/
+#ifndef PROFILER_H
+#define PROFILER_H
+
+#include <atomic>
+#include <chrono>
+
+#include <glad/glad.h> // Only for the GL types, the Profiler makes no GL calls (see GPUTimer)
+
+
+// Every zone the Profiler keeps timings of
+enum ProfileZone : GLubyte
+{
+    ZONE_PROCESS_INPUT,
+    ZONE_UPDATE,
+    ZONE_COLLISIONS,
+    ZONE_RENDER,
+    ZONE_GPU_RENDER,    // Filled in by a GPUTimer, a few frames late
+    NUM_PROFILE_ZONES
+};
+
+// Number of frames whose timings are kept for the statistics and the CSV dump
+const GLuint PROFILE_HISTORY = 300;
+
+// Statistics of a zone over the kept frames it was timed in, in milliseconds
+struct ProfileStats
+{
+    GLdouble Min, Average, P99;
+    GLuint   Frames; // Number of frames the statistics are made of
+};
+
+// A static singleton Profiler class that keeps the time spent in each zone for
+// each of the last PROFILE_HISTORY frames. Zones are timed on the CPU with
+// Begin()/End() (or a ProfileScope), and may be entered any number of times per
+// frame; results that only become available later (like the GPU's) are added to
+// the frame they belong to with Record(). It makes no GL calls, so it also works
+// in headless builds.
+// Frames are started by the render thread; zones timed on the simulation thread
+// are added to whichever frame is current when they end. The timings are
+// atomics, so they can be added to from both threads while the render thread
+// reads them. A zone must always be timed on the same thread.
+class Profiler
+{
+public:
+    // Zones are only timed while enabled
+    static GLboolean Enabled;
+    // Starts a new frame, the timings of the oldest kept frame are dropped
+    static void         BeginFrame();
+    // Starts and stops timing a zone on the CPU (zones can't be nested in themselves)
+    static void         Begin(ProfileZone zone);
+    static void         End(ProfileZone zone);
+    // Adds a time that was measured elsewhere to a frame, ignored if the frame isn't kept anymore
+    static void         Record(ProfileZone zone, GLuint64 frame, GLdouble milliseconds);
+    // Number of the current frame
+    static GLuint64     Frame();
+    // Minimum, average and 99th percentile of the zone over the kept frames before the current one
+    static ProfileStats Stats(ProfileZone zone);
+    // Writes the timings of all kept frames before the current one to a CSV file, one row per frame
+    static GLboolean    WriteCSV(const GLchar *file);
+    // Returns the name of a zone as used in the CSV header
+    static const GLchar * ZoneName(ProfileZone zone);
+    // Forgets all timings
+    static void         Clear();
+private:
+    // Milliseconds spent in each zone per kept frame, negative if the zone wasn't timed in the frame
+    static std::atomic<GLdouble> times[PROFILE_HISTORY][NUM_PROFILE_ZONES];
+    static std::atomic<GLuint64> frame;
+    // Zones that are being timed, and when they were entered
+    static GLboolean open[NUM_PROFILE_ZONES];
+    static std::chrono::steady_clock::time_point started[NUM_PROFILE_ZONES];
+    // Private constructor, that is we do not want any actual profiler objects. Its members and functions should be publicly available (static).
+    Profiler() { }
+};
+
+// Times the enclosing scope as a zone of the Profiler
+class ProfileScope
+{
+public:
+    ProfileScope(ProfileZone zone) : zone(zone), timing(Profiler::Enabled) { if (this->timing) Profiler::Begin(zone); }
+    ~ProfileScope() { if (this->timing) Profiler::End(this->zone); }
+private:
+    ProfileZone zone;
+    GLboolean   timing;
+};
+
+#endif
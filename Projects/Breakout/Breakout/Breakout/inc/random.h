@@ -0,0 +1,41 @@
+/*******************************************************************
+** This code is part of Breakout.
+**
+** Breakout is free software: you can redistribute it and/or modify
+** it under the terms of the CC BY 4.0 license as published by
+** Creative Commons, either version 4 of the License, or (at your
+** option) any later version.
+******************************************************************/
+#ifndef RANDOM_H
+#define RANDOM_H
+
+#include <glad/glad.h>
+
+
+// A small seeded pseudo-random number generator (SplitMix64).
+// Unlike rand() it has no hidden global state: every owner has its own
+// generator, so the same seed always gives the same sequence on every
+// platform, whatever else is drawing random numbers.
+class Random
+{
+public:
+    Random(GLuint64 seed = 0) : state(seed) { }
+    // Restarts the sequence
+    void     Seed(GLuint64 seed) { this->state = seed; }
+    // The next 32 random bits
+    GLuint   Next()
+    {
+        GLuint64 z = (this->state += 0x9E3779B97F4A7C15ull);
+        z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ull;
+        z = (z ^ (z >> 27)) * 0x94D049BB133111EBull;
+        return static_cast<GLuint>((z ^ (z >> 31)) >> 32);
+    }
+    // A random number in [0, bound) (bound must be greater than 0)
+    GLuint   Below(GLuint bound) { return this->Next() % bound; }
+    // Where the generator is in its sequence, two generators with the same state give the same numbers
+    GLuint64 State() const { return this->state; }
+private:
+    GLuint64 state;
+};
+
+#endif
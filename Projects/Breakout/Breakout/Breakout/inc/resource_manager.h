@@ -9,13 +9,29 @@
 #ifndef RESOURCE_MANAGER_H
 #define RESOURCE_MANAGER_H
 
+#include <condition_variable>
+#include <future>
 #include <map>
+#include <memory>
+#include <mutex>
 #include <string>
+#include <vector>
 
 #include <glad/glad.h>
 
 #include "texture.h"
+#include "texture_atlas.h"
 #include "shader.h"
+#include "thread_pool.h"
+
+
+// Called while images are loading, e.g. to draw a loading screen (on the GL thread)
+typedef void (*LoadProgressCallback)(GLuint loaded, GLuint total);
+
+// Handles of stored resources (indices into the ResourceManager's storage)
+typedef GLuint ShaderHandle;
+typedef GLuint TextureHandle;
+typedef GLuint SpriteHandle;
 
 
 // A static singleton ResourceManager class that hosts several
@@ -23,23 +39,99 @@
 // and/or shader is also stored for future reference by string
 // handles. All functions and resources are static and no 
 // public constructor is defined.
+// Names are interned into handles that index dense arrays: a name is
+// looked up once (e.g. at load time) and the handle is used from then on,
+// so retrieving a resource by handle is a single array access. A handle
+// can be taken before its resource is loaded, it stays the same for the
+// whole run. References to stored resources are only valid until the
+// next resource of the same kind is interned.
+// Images can be decoded on a pool of worker threads (one per core);
+// the GL thread uploads them as they finish (see UpdateLoading() and FinishLoading()).
 class ResourceManager
 {
 public:
-   // Resource storage
-   static std::map<std::string, Shader>    Shaders;
-   static std::map<std::string, Texture2D> Textures;
+   // Resource storage (indexed by handle)
+   static std::vector<Shader>              Shaders;
+   static std::vector<Texture2D>           Textures;
+   static std::vector<SpriteRegion>        Sprites;
+   static std::vector<Texture2D>           AtlasPages;
+   // Returns the handle of the shader/texture/sprite with the given name, interning the name if it wasn't seen before
+   // (the handle refers to an empty resource, which holds no GL object, until one is loaded under that name)
+   static ShaderHandle  ShaderID(const std::string &name);
+   static TextureHandle TextureID(const std::string &name);
+   static SpriteHandle  SpriteID(const std::string &name);
    // Loads (and generates) a shader program from file loading vertex, fragment (and geometry) shader's source code. If gShaderFile is not nullptr, it also loads a geometry shader
-   static Shader   LoadShader(const GLchar *vShaderFile, const GLchar *fShaderFile, const GLchar *gShaderFile, std::string name);
+   static Shader   LoadShader(const GLchar *vShaderFile, const GLchar *fShaderFile, const GLchar *gShaderFile, const std::string &name);
    // Retrieves a stored shader
-   static Shader   GetShader(std::string name);
+   static Shader & GetShader(ShaderHandle handle);
+   // Retrieves a stored shader by name (looks the name up every call, keep a handle to retrieve it often)
+   static const Shader & GetShader(const std::string &name);
    // Loads (and generates) a texture from file
-   static Texture2D LoadTexture(const GLchar *file, GLboolean alpha, std::string name);
+   static Texture2D LoadTexture(const GLchar *file, GLboolean alpha, const std::string &name);
+   // Starts decoding a texture on a worker thread. It is generated (and stored) by the GL thread once decoded,
+   // in UpdateLoading() or FinishLoading(), which is also when the returned future becomes ready
+   static std::shared_future<Texture2D> LoadTextureAsync(const GLchar *file, GLboolean alpha, const std::string &name);
    // Retrieves a stored texture
-   static Texture2D GetTexture(std::string name);
+   static const Texture2D & GetTexture(TextureHandle handle);
+   // Retrieves a stored texture by name (looks the name up every call, keep a handle to retrieve it often)
+   static const Texture2D & GetTexture(const std::string &name);
+   // Starts decoding an image on a worker thread, it is packed into the sprite atlas the next time BuildAtlas is called
+   static void      AddAtlasSprite(const GLchar *file, const std::string &name);
+   // Packs all queued images into as few atlas pages of pageSize x pageSize pixels as possible and uploads them
+   // (waits for the images that are still being decoded)
+   static void      BuildAtlas(GLuint pageSize = 1024);
+   // Uploads the images that finished decoding since the last call without waiting for the others;
+   // returns GL_TRUE once all queued images are loaded (GL thread only)
+   static GLboolean UpdateLoading();
+   // Waits for all queued images to be decoded and uploads them, reporting the progress whenever one finished (GL thread only)
+   static void      FinishLoading(LoadProgressCallback progress = nullptr);
+   // Retrieves a stored sprite (a sub-rectangle of an atlas page)
+   static const SpriteRegion & GetSprite(SpriteHandle handle);
+   // Retrieves a stored sprite by name (looks the name up every call, keep a handle to retrieve it often)
+   static const SpriteRegion & GetSprite(const std::string &name);
+   // Reports every name that was interned but that nothing was loaded under (like a misspelled one), returns how many there are
+   static GLuint    CheckLoaded();
    // Properly de-allocates all loaded resources
    static void      Clear();
 private:
+   // An image waiting to be packed into the atlas (always 4 channels)
+   struct AtlasImage
+   {
+      std::string    Name;
+      SpriteHandle   Sprite;
+      GLint          Width, Height;
+      unsigned char *Pixels;
+   };
+   static std::vector<AtlasImage> pendingAtlasImages;
+   // An image being decoded by a worker thread
+   struct DecodeJob
+   {
+      std::string    File, Name;
+      GLuint         Handle;         // Handle of the texture or sprite the image is stored as
+      GLboolean      Alpha;          // Texture jobs only: whether the texture has an alpha channel
+      GLboolean      Atlas;          // Whether the image goes into the atlas instead of its own texture
+      GLint          Width, Height;
+      unsigned char *Pixels;         // Decoded image, null if decoding failed
+      std::promise<Texture2D> Texture;
+   };
+   static ThreadPool *decoders;      // Created on the first asynchronous load
+   static std::mutex  decodedMutex;  // Guards decodedJobs
+   static std::condition_variable decodedReady;
+   static std::vector<std::shared_ptr<DecodeJob>> decodedJobs; // Decoded images waiting for the GL thread
+   static GLuint      loadsQueued, loadsFinished;
+   // Handle of every interned name
+   static std::map<std::string, ShaderHandle>  shaderIDs;
+   static std::map<std::string, TextureHandle> textureIDs;
+   static std::map<std::string, SpriteHandle>  spriteIDs;
+   // Returns the handle of a name, adding an empty resource for it to the storage if it wasn't interned yet
+   template <typename T>
+   static GLuint    intern(std::map<std::string, GLuint> &ids, std::vector<T> &storage, const std::string &name);
+   // Returns the handle of a name that should already be interned, or -1 (and reports it) if it isn't
+   static GLint     find(const std::map<std::string, GLuint> &ids, const std::string &name, const GLchar *kind);
+   // Queues an image to be decoded by the worker threads
+   static void      decodeAsync(std::shared_ptr<DecodeJob> job);
+   // Uploads a decoded image as its texture, or queues it for the atlas (GL thread only)
+   static void      finishDecode(DecodeJob &job);
    // Private constructor, that is we do not want any actual resource manager objects. Its members and functions should be publicly available (static).
    ResourceManager() { }
    // Loads and generates a shader from file
@@ -9,6 +9,7 @@
 #ifndef SHADER_H
 #define SHADER_H
 
+#include <map>
 #include <string>
 
 #include <glad/glad.h>
@@ -16,6 +17,10 @@
 #include <glm/gtc/type_ptr.hpp>
 
 
+// Uniform buffer binding point of the FrameConstants block shared by all shaders
+const GLuint FRAME_CONSTANTS_BINDING = 0;
+
+
 // General purpose shader object. Compiles from file, generates
 // compile/link-time error messages and hosts several utility
 // functions for easy management.
@@ -25,11 +30,13 @@ public:
    // State
    GLuint ID;
    // Constructor
-   Shader() { }
+   Shader() : ID(0) { }
    // Sets the current shader as active
    Shader& Use();
    // Compiles the shader from given source code
    void    Compile(const GLchar *vertexSource, const GLchar *fragmentSource, const GLchar *geometrySource = nullptr); // Note: geometry source code is optional 
+   // Returns the location of a uniform as resolved at link time (-1 if the uniform isn't active)
+   GLint   GetUniformLocation(const GLchar *name) const;
                                                                                                                       // Utility functions
    void    SetFloat    (const GLchar *name, GLfloat value,                              GLboolean useShader = false);
    void    SetInteger  (const GLchar *name, GLint value,                                GLboolean useShader = false);
@@ -40,9 +47,20 @@ public:
    void    SetVector4f (const GLchar *name, GLfloat x, GLfloat y, GLfloat z, GLfloat w, GLboolean useShader = false);
    void    SetVector4f (const GLchar *name, const glm::vec4 &value,                     GLboolean useShader = false);
    void    SetMatrix4  (const GLchar *name, const glm::mat4 &matrix,                    GLboolean useShader = false);
+   // Same as above, but for a location obtained through GetUniformLocation (no lookup at all)
+   void    SetFloat    (GLint location, GLfloat value,                                  GLboolean useShader = false);
+   void    SetInteger  (GLint location, GLint value,                                    GLboolean useShader = false);
+   void    SetVector2f (GLint location, const glm::vec2 &value,                         GLboolean useShader = false);
+   void    SetVector3f (GLint location, const glm::vec3 &value,                         GLboolean useShader = false);
+   void    SetVector4f (GLint location, const glm::vec4 &value,                         GLboolean useShader = false);
+   void    SetMatrix4  (GLint location, const glm::mat4 &matrix,                        GLboolean useShader = false);
 private:
+   // Locations of all active uniforms, resolved once after linking
+   std::map<std::string, GLint> uniformLocations;
    // Checks if compilation or linking failed and if so, print the error logs
    void    checkCompileErrors(GLuint object, std::string type);
+   // Fills uniformLocations and connects the FrameConstants block (if any) to its binding point
+   void    resolveUniforms();
 };
 
 #endif
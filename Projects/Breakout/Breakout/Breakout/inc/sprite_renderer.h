@@ -8,30 +8,73 @@
 ******************************************************************/
 #ifndef SPRITE_RENDERER_H
 #define SPRITE_RENDERER_H
+#include <vector>
 
 #include <glad/glad.h>
 #include <glm/glm.hpp>
 #include <glm/gtc/matrix_transform.hpp>
 
 #include "texture.h"
+#include "texture_atlas.h"
 #include "shader.h"
 
 
+// Per-instance state of a single sprite, streamed to the GPU as vertex attributes
+struct SpriteInstance
+{
+    glm::vec2 Position; // Top left corner of the sprite
+    glm::vec2 Size;
+    GLfloat   Rotation; // Rotation around the center of the sprite (in radians)
+    glm::vec3 Color;
+    glm::vec4 TexRect;  // <vec2 offset, vec2 scale> of the sprite within its texture
+};
+
+
+// SpriteRenderer draws textured quads. Sprites can either be drawn one by one
+// through DrawSprite() or gathered between Begin() and Flush(), in which case
+// all sprites that share a texture are drawn with a single instanced draw call.
+// Sprites packed into the same atlas page therefore all end up in one draw call.
 class SpriteRenderer
 {
 public:
     // Constructor (inits shaders/shapes)
-    SpriteRenderer(Shader &shader);
+    SpriteRenderer(const Shader &shader);
     // Destructor
     ~SpriteRenderer();
-    // Renders a defined quad textured with given sprite
+    // Renders a defined quad textured with given sprite (queued instead if a batch is open)
     void DrawSprite(Texture2D &texture, glm::vec2 position, glm::vec2 size = glm::vec2(10, 10), GLfloat rotate = 0.0f, glm::vec3 color = glm::vec3(1.0f));
+    // Opens a batch; sprites submitted from now on are only drawn when Flush() is called
+    void Begin();
+    // Queues a sprite into the open batch
+    void Submit(const Texture2D &texture, glm::vec2 position, glm::vec2 size = glm::vec2(10, 10), GLfloat rotate = 0.0f, glm::vec3 color = glm::vec3(1.0f));
+    // Queues a sprite that covers only a region of its texture into the open batch
+    void Submit(const SpriteRegion &sprite, glm::vec2 position, glm::vec2 size = glm::vec2(10, 10), GLfloat rotate = 0.0f, glm::vec3 color = glm::vec3(1.0f));
+    // Queues the same sprite at each of the given positions into the open batch
+    void Submit(const SpriteRegion &sprite, const std::vector<glm::vec2> &positions, glm::vec2 size = glm::vec2(10, 10), GLfloat rotate = 0.0f, glm::vec3 color = glm::vec3(1.0f));
+    // Draws all queued sprites (one draw call per texture, in order of first submission) and closes the batch
+    void Flush();
 private:
+    // All the queued instances that share a texture
+    struct SpriteBatch
+    {
+        GLuint                      TextureID;
+        std::vector<SpriteInstance> Instances;
+    };
     // Render state
     Shader shader;
     GLuint quadVAO;
+    GLuint instanceVBO;
+    GLuint instanceCapacity; // Number of instances the instance buffer can currently hold
+    // Batch state (batches are kept between frames so their storage is reused)
+    std::vector<SpriteBatch> batches;
+    GLuint                   activeBatches;
+    GLboolean                batching;
+    // Returns the open batch of the given texture, opening a new one if there is none yet
+    SpriteBatch &batchOf(const Texture2D &texture);
     // Initializes and configures the quad's buffer and vertex attributes
     void initRenderData();
+    // Points the per-instance attributes at the given instance offset within the instance buffer
+    void setInstanceAttributes(GLuint firstInstance);
 };
 
 #endif
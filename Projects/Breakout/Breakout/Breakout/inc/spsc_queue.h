@@ -0,0 +1,55 @@
+/*******************************************************************
+** This code is part of Breakout.
+**
+** Breakout is free software: you can redistribute it and/or modify
+** it under the terms of the CC BY 4.0 license as published by
+** Creative Commons, either version 4 of the License, or (at your
+** option) any later version.
+******************************************************************/
+#ifndef SPSC_QUEUE_H
+#define SPSC_QUEUE_H
+
+#include <atomic>
+
+#include <glad/glad.h>
+
+
+// A fixed size queue that one thread pushes to while another one pops from,
+// without locks: each side only writes its own index, and publishes it with
+// release semantics after the slot it filled or emptied. Neither side ever
+// waits; Push() fails when the queue is full and Pop() when it is empty.
+// One slot is always left unused to tell a full queue from an empty one.
+template <typename T, GLuint Capacity>
+class SPSCQueue
+{
+public:
+    SPSCQueue() : head(0), tail(0) { }
+    // Adds an item to the back of the queue (producer thread only), returns GL_FALSE if the queue is full
+    GLboolean Push(const T &item)
+    {
+        GLuint tail = this->tail.load(std::memory_order_relaxed);
+        GLuint next = (tail + 1) % Capacity;
+        if (next == this->head.load(std::memory_order_acquire))
+            return GL_FALSE;
+        this->items[tail] = item;
+        this->tail.store(next, std::memory_order_release);
+        return GL_TRUE;
+    }
+    // Takes the item at the front of the queue (consumer thread only), returns GL_FALSE if the queue is empty
+    GLboolean Pop(T &item)
+    {
+        GLuint head = this->head.load(std::memory_order_relaxed);
+        if (head == this->tail.load(std::memory_order_acquire))
+            return GL_FALSE;
+        item = this->items[head];
+        this->head.store((head + 1) % Capacity, std::memory_order_release);
+        return GL_TRUE;
+    }
+private:
+    std::atomic<GLuint> head; // Next slot to pop, only written by the consumer
+    GLchar              padding[64 - sizeof(std::atomic<GLuint>)]; // Keeps the indices on separate cache lines, so the threads don't keep stealing the line from each other
+    std::atomic<GLuint> tail; // Next slot to push, only written by the producer
+    T                   items[Capacity];
+};
+
+#endif
@@ -9,7 +9,8 @@
 #ifndef TEXT_RENDERER_H
 #define TEXT_RENDERER_H
 
-#include <map>
+#include <string>
+#include <vector>
 
 #include <glad/glad.h>
 #include <glm/glm.hpp>
@@ -18,31 +19,100 @@
 #include "shader.h"
 
 struct Character {
-    GLuint     TextureID; // ID handle of the glyph texture
-    glm::ivec2 Size;      // Size of glyph
-    glm::ivec2 Bearing;   // Offset from baseline to left/top of glyph
+    glm::vec4  UV;        // <vec2 offset, vec2 scale> of the glyph within the glyph atlas
+    glm::vec2  Size;      // Size of glyph
+    glm::vec2  Bearing;   // Offset from baseline to left/top of glyph
     GLuint     Advance;   // Horizontal offset to advance to next glyph
 };
 
+// A single vertex of a glyph quad
+struct TextVertex {
+    glm::vec2 Position;
+    glm::vec2 TexCoords;
+    glm::vec3 Color;
+};
+
+// Number of characters (starting at code point 0) that are loaded from the font
+const GLuint NUM_CHARACTERS = 128;
+
+// Pixel size at which distance field glyphs are stored in the atlas (whatever the size they are rendered at)
+const GLuint SDF_GLYPH_SIZE = 32;
+// Distance (in atlas pixels) over which the distance field fades from inside to outside a glyph
+const GLuint SDF_SPREAD = 4;
+// Factor by which glyphs are rasterized larger than SDF_GLYPH_SIZE to measure the distances accurately
+const GLuint SDF_UPSAMPLING = 8;
+
+// Identifies a string whose layout is cached by a TextRenderer
+typedef GLuint TextHandle;
+
+// Writes the decimal representation of value followed by a null terminator into buffer without allocating.
+// The buffer must have room for at least 12 characters. Returns the number of digits (and sign) written.
+GLuint FormatInteger(GLint value, GLchar *buffer);
+// Same as above for unsigned values, the buffer must have room for at least 11 characters
+GLuint FormatInteger(GLuint value, GLchar *buffer);
+
 
 // A class for rendering text using a font loaded with the FreeType library.
-// A single font is loaded, processed and stored in a list of Character objects for later rendering.
+// All glyphs of a font are rasterized into a single atlas texture, either as plain coverage
+// bitmaps or as signed distance fields, which stay crisp at any scale. The quads of all the strings
+// rendered between Begin() and Flush() end up in one vertex buffer and are drawn with one draw call.
 class TextRenderer
 {
 public:
-    // Holds a list of pre-compiled Characters
-    std::map<GLchar, Character> Characters;
+    // Holds a list of pre-compiled Characters, indexed by code point
+    Character Characters[NUM_CHARACTERS];
+    // Texture holding the glyphs of all Characters
+    Texture2D GlyphAtlas;
     // Shader used for text rendering
     Shader TextShader;
     // Constructor
-    TextRenderer(GLuint width, GLuint height);
+    TextRenderer();
+    // Destructor
+    ~TextRenderer();
     // Pre-compiles a list of characters from the given font
     void Load(std::string font, GLuint fontSize);
-    // Renders a string of text using the precompiled list of characters
-    void RenderText(std::string text, GLfloat x, GLfloat y, GLfloat scale, glm::vec3 color = glm::vec3(1.0f));
+    // Pre-compiles a list of characters from the given font as signed distance fields
+    // The glyphs are laid out at fontSize, but can be rendered crisply at any scale
+    void LoadDistanceField(std::string font, GLuint fontSize);
+    // Renders a string of text using the precompiled list of characters (queued instead if a batch is open)
+    void RenderText(const std::string &text, GLfloat x, GLfloat y, GLfloat scale, glm::vec3 color = glm::vec3(1.0f));
+    // Reserves room for a string of at most maxLength characters whose layout is kept between frames
+    TextHandle CreateCachedText(GLuint maxLength);
+    // Renders a cached string; it is only laid out again if its content, position, scale or color changed since the last call
+    void RenderCachedText(TextHandle handle, const GLchar *text, GLfloat x, GLfloat y, GLfloat scale, glm::vec3 color = glm::vec3(1.0f));
+    // Opens a batch; text rendered from now on is only drawn when Flush() is called
+    void Begin();
+    // Draws all queued text (one draw call for the dynamic text and one for the cached strings) and closes the batch
+    void Flush();
 private:
+    // A string laid out into its own range of the cached vertex buffer
+    struct CachedText {
+        std::string Text;
+        GLfloat     X, Y, Scale;
+        glm::vec3   Color;
+        GLuint      FirstVertex, MaxVertices, NumVertices;
+        GLboolean   Valid;        // False until laid out and whenever a new font is loaded
+    };
     // Render state
     GLuint VAO, VBO;
+    GLuint vertexCapacity;            // Number of vertices the VBO can currently hold
+    std::vector<TextVertex> vertices; // Queued glyph quads
+    GLboolean batching;
+    // Cached text state
+    GLuint cachedVAO, cachedVBO;
+    std::vector<TextVertex> cachedVertices; // CPU copy of the cached VBO
+    std::vector<CachedText> cachedTexts;
+    std::vector<GLint>      cachedFirsts;   // Ranges of the cached VBO queued for the next Flush
+    std::vector<GLsizei>    cachedCounts;
+    GLboolean               cachedResized;  // Set when the cached VBO must be reallocated
+    // Vertical bearing of 'H', used to align the top of all the glyphs of a line
+    GLfloat capHeight;
+    // Packs the given glyph bitmaps (one byte per pixel) into the glyph atlas and sets the UVs of the Characters
+    void buildGlyphAtlas(const std::vector<unsigned char> bitmaps[NUM_CHARACTERS], const glm::ivec2 bitmapSizes[NUM_CHARACTERS]);
+    // Lays out at most maxGlyphs characters of text into out and returns the number of vertices written
+    GLuint layoutText(const GLchar *text, GLfloat x, GLfloat y, GLfloat scale, glm::vec3 color, TextVertex *out, GLuint maxGlyphs) const;
+    // Configures the vertex attributes of the currently bound VAO/VBO
+    void   setVertexAttributes();
 };
 
 #endif
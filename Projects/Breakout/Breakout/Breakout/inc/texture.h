@@ -30,7 +30,7 @@ public:
    GLuint Filter_Min;      // Filtering mode if texture pixels < screen pixels
    GLuint Filter_Max;      // Filtering mode if texture pixels > screen pixels
 
-   // Constructor (sets default texture modes)
+   // Constructor (sets default texture modes, the texture object is created by the first call to Generate)
    Texture2D();
    // Generates texture from image data
    void Generate(GLuint width, GLuint height, unsigned char* data);
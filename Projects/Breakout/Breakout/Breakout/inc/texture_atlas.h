@@ -0,0 +1,55 @@
+/*******************************************************************
+** This code is part of Breakout.
+**
+** Breakout is free software: you can redistribute it and/or modify
+** it under the terms of the CC BY 4.0 license as published by
+** Creative Commons, either version 4 of the License, or (at your
+** option) any later version.
+******************************************************************/
+#ifndef TEXTURE_ATLAS_H
+#define TEXTURE_ATLAS_H
+#include <vector>
+
+#include <glad/glad.h>
+#include <glm/glm.hpp>
+
+#include "texture.h"
+
+
+// A sprite stored somewhere within a texture. Sprites that were packed into an
+// atlas share their texture, which lets the SpriteRenderer draw them together.
+struct SpriteRegion
+{
+    Texture2D Texture; // Texture (or atlas page) holding the sprite
+    glm::vec4 UV;      // <vec2 offset, vec2 scale> of the sprite within the texture in normalized coordinates
+
+    SpriteRegion() : Texture(), UV(0.0f, 0.0f, 1.0f, 1.0f) { }
+    // A sprite that covers a whole texture
+    SpriteRegion(const Texture2D &texture) : Texture(texture), UV(0.0f, 0.0f, 1.0f, 1.0f) { }
+    SpriteRegion(const Texture2D &texture, glm::vec4 uv) : Texture(texture), UV(uv) { }
+};
+
+
+// SkylinePacker places rectangles on a single atlas page using the skyline bottom-left heuristic.
+// The skyline is the upper outline of everything packed so far, stored as a list of horizontal segments.
+class SkylinePacker
+{
+public:
+    // Constructor
+    SkylinePacker(GLuint width, GLuint height);
+    // Finds room for a rectangle of the given size, returns false if it doesn't fit on the page anymore
+    GLboolean Pack(GLuint width, GLuint height, glm::uvec2 &position);
+private:
+    // A horizontal segment of the skyline
+    struct Segment
+    {
+        GLint X, Y, Width;
+    };
+    // State
+    GLint width, height;
+    std::vector<Segment> skyline;
+    // Returns the height at which a rectangle would rest if its left edge is placed on the given segment, or -1 if it doesn't fit there
+    GLint fit(GLuint segment, GLint width, GLint height) const;
+};
+
+#endif
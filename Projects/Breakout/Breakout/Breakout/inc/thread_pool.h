@@ -0,0 +1,45 @@
+/*******************************************************************
+** This code is part of Breakout.
+**
+** Breakout is free software: you can redistribute it and/or modify
+** it under the terms of the CC BY 4.0 license as published by
+** Creative Commons, either version 4 of the License, or (at your
+** option) any later version.
+******************************************************************/
+#ifndef THREAD_POOL_H
+#define THREAD_POOL_H
+
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include <glad/glad.h>
+
+
+// A fixed set of worker threads that run the tasks submitted to them, in the
+// order in which they were submitted. Tasks must not make any GL calls.
+class ThreadPool
+{
+public:
+    // Constructor (0 threads starts one per core)
+    ThreadPool(GLuint threads = 0);
+    // Destructor (runs the tasks that are still queued before the workers exit)
+    ~ThreadPool();
+    // Queues a task to run on one of the workers
+    void   Submit(std::function<void()> task);
+    // Number of worker threads
+    GLuint Size() const;
+private:
+    std::vector<std::thread>          workers;
+    std::deque<std::function<void()>> tasks;
+    std::mutex                        mutex;    // Guards tasks and stopping
+    std::condition_variable           wake;     // Signalled when a task is queued or the pool is stopping
+    GLboolean                         stopping;
+    // Body of the workers
+    void work();
+};
+
+#endif
@@ -0,0 +1,58 @@
+/*******************************************************************
+** This code is part of Breakout.
+**
+** Breakout is free software: you can redistribute it and/or modify
+** it under the terms of the CC BY 4.0 license as published by
+** Creative Commons, either version 4 of the License, or (at your
+** option) any later version.
+******************************************************************/
+#ifndef TRIPLE_BUFFER_H
+#define TRIPLE_BUFFER_H
+
+#include <atomic>
+
+#include <glad/glad.h>
+
+
+// Hands the latest version of a value from one thread (the writer) to
+// another (the reader) without locks and without either side ever waiting.
+// The writer fills its back slot and publishes it by exchanging it with the
+// middle slot; the reader takes the middle slot in exchange for its front
+// slot whenever a newer value was published. Each slot is only ever touched
+// by the thread that currently owns it, so values are never copied by the
+// buffer and their storage is reused. Values the reader didn't get to before
+// the next one was published are skipped.
+template <typename T>
+class TripleBuffer
+{
+public:
+    TripleBuffer() : front(0), middle(1), back(2) { }
+    // The slot the writer fills in (writer thread only)
+    T &       Back() { return this->slots[this->back]; }
+    // Makes the back slot the latest value, the writer gets an older slot to fill next (writer thread only)
+    void      Publish()
+    {
+        GLuint old = this->middle.exchange(this->back | FRESH, std::memory_order_acq_rel);
+        this->back = old & ~FRESH;
+    }
+    // Takes the latest value if one was published since the last call, returns whether Front() changed (reader thread only)
+    GLboolean Update()
+    {
+        if (!(this->middle.load(std::memory_order_relaxed) & FRESH))
+            return GL_FALSE;
+        GLuint old = this->middle.exchange(this->front, std::memory_order_acq_rel);
+        this->front = old & ~FRESH;
+        return GL_TRUE;
+    }
+    // The value the reader took last (reader thread only)
+    const T & Front() const { return this->slots[this->front]; }
+private:
+    // Set on the middle slot's index while it holds a value the reader hasn't taken yet
+    static const GLuint FRESH = 4;
+    T                   slots[3];
+    GLuint              front;  // Only used by the reader
+    std::atomic<GLuint> middle; // Exchanged by both
+    GLuint              back;   // Only used by the writer
+};
+
+#endif
@@ -0,0 +1,17 @@
+#version 330 core
+
+in  vec2  TexCoords;
+
+out vec4  color;
+
+uniform sampler2D scene;
+uniform vec2      step; // Distance between the taps (horizontal or vertical, the blur is split in two passes)
+
+void main()
+{
+    // One dimension of the 3x3 gaussian kernel (1 2 1) / 4
+    vec3 sum = texture(scene, TexCoords - step).rgb * 0.25f
+             + texture(scene, TexCoords).rgb        * 0.5f
+             + texture(scene, TexCoords + step).rgb * 0.25f;
+    color = vec4(sum, 1.0f);
+}
@@ -0,0 +1,18 @@
+#version 330 core
+
+in  vec2  TexCoords;
+
+out vec4  color;
+
+uniform sampler2D scene;
+uniform vec2      step; // Distance between the taps
+
+void main()
+{
+    // Edge detection kernel: 8 times the center minus its 8 neighbours
+    vec3 sum = texture(scene, TexCoords).rgb * 9.0f;
+    for (int y = -1; y <= 1; y++)
+        for (int x = -1; x <= 1; x++)
+            sum -= texture(scene, TexCoords + vec2(x, y) * step).rgb;
+    color = vec4(sum, 1.0f);
+}
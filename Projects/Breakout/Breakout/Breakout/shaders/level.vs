@@ -0,0 +1,29 @@
+#version 330 core
+
+layout (location = 0) in vec4 vertex; // <vec2 position, vec2 texCoords>
+layout (location = 1) in vec3 color;
+layout (location = 2) in vec2 cell;   // Grid cell of the brick the vertex belongs to
+
+out vec2 TexCoords;
+out vec3 BrickColor;
+
+layout (std140) uniform FrameConstants
+{
+    mat4  projection;
+    float time;
+    bool  confuse;
+    bool  chaos;
+    bool  shake;
+};
+
+uniform sampler2D liveness; // One texel per grid cell, 1.0 while the brick in that cell is alive
+
+void main()
+{
+    TexCoords = vertex.zw;
+    BrickColor = color;
+
+    // Destroyed bricks collapse into a degenerate quad that produces no fragments
+    float alive = step(0.5, texelFetch(liveness, ivec2(cell), 0).r);
+    gl_Position = alive * (projection * vec4(vertex.xy, 0.0, 1.0));
+}
@@ -1,16 +1,25 @@
 #version 330 core
-layout (location = 0) in vec4 vertex; // <vec2 position, vec2 texCoords>
+layout (location = 0) in vec4 vertex;      // <vec2 position, vec2 texCoords>
+layout (location = 1) in vec2 translation; // Per instance
+layout (location = 2) in vec4 color;       // Per instance
 
 out vec2 TexCoords;
 out vec4 ParticleColor;
 
-uniform vec4 color;
-uniform vec2 translation;
-uniform mat4 projection;
+layout (std140) uniform FrameConstants
+{
+    mat4  projection;
+    float time;
+    bool  confuse;
+    bool  chaos;
+    bool  shake;
+};
+
+uniform vec4 texRect; // <vec2 offset, vec2 scale> of the particle sprite within its texture
 
 void main()
 {
-    TexCoords = vertex.zw;
+    TexCoords = texRect.xy + vertex.zw * texRect.zw;
     ParticleColor = color;
 
     float scale = 10.0f;
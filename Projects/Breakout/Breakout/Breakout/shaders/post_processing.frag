@@ -4,44 +4,21 @@ in  vec2  TexCoords;
 
 out vec4  color;
 
-uniform sampler2D scene;
-uniform vec2      offsets[9];
-uniform int       edge_kernel[9];
-uniform float     blur_kernel[9];
+uniform sampler2D scene; // Output of the last pass of the effect graph
 
-uniform bool chaos;
-uniform bool confuse;
-uniform bool shake;
+layout (std140) uniform FrameConstants
+{
+    mat4  projection;
+    float time;
+    bool  confuse;
+    bool  chaos;
+    bool  shake;
+};
 
 void main()
 {
-    color = vec4(0.0f);
-    vec3 sample[9];
-
-    // Sample from texture offsets if using convolution matrix
-    if(chaos || shake)
-        for(int i = 0; i < 9; i++)
-            sample[i] = vec3(texture(scene, TexCoords.st + offsets[i]));
-
-    // Process effects
-    if(chaos)
-    {
-        for(int i = 0; i < 9; i++)
-            color += vec4(sample[i] * edge_kernel[i], 0.0f);
-        color.a = 1.0f;
-    }
-    else if(confuse)
-    {
-        color = vec4(1.0 - texture(scene, TexCoords).rgb, 1.0);
-    }
-    else if(shake)
-    {
-        for(int i = 0; i < 9; i++)
-            color += vec4(sample[i] * blur_kernel[i], 0.0f);
-        color.a = 1.0f;
-    }
-    else
-    {
-        color =  texture(scene, TexCoords);
-    }
+    // The edge (chaos) and blur (shake) kernels were run by the passes before this one, chaos overrides confuse
+    color = texture(scene, TexCoords);
+    if (confuse && !chaos)
+        color = vec4(1.0 - color.rgb, 1.0);
 }
@@ -1,14 +1,34 @@
 #version 330 core
 
-layout (location = 0) in vec4 vertex; // <vec2 position, vec2 texCoords>
+layout (location = 0) in vec4  vertex;    // <vec2 position, vec2 texCoords>
+layout (location = 1) in vec4  transform; // Per instance: <vec2 position, vec2 size>
+layout (location = 2) in float rotation;  // Per instance
+layout (location = 3) in vec3  color;     // Per instance
+layout (location = 4) in vec4  texRect;   // Per instance: <vec2 offset, vec2 scale> within the texture
 
 out vec2 TexCoords;
+out vec3 SpriteColor;
 
-uniform mat4 model;
-uniform mat4 projection;
+layout (std140) uniform FrameConstants
+{
+    mat4  projection;
+    float time;
+    bool  confuse;
+    bool  chaos;
+    bool  shake;
+};
 
 void main()
 {
-    TexCoords = vertex.zw;
-    gl_Position = projection * model * vec4(vertex.xy, 0.0, 1.0);
+    TexCoords = texRect.xy + vertex.zw * texRect.zw;
+    SpriteColor = color;
+
+    // Scale the unit quad, rotate it around its center and then move its top left corner to the sprite's position
+    vec2 size = transform.zw;
+    vec2 centered = (vertex.xy - 0.5) * size;
+    float s = sin(rotation);
+    float c = cos(rotation);
+    vec2 rotated = vec2(c * centered.x - s * centered.y, s * centered.x + c * centered.y);
+
+    gl_Position = projection * vec4(rotated + 0.5 * size + transform.xy, 0.0, 1.0);
 }
@@ -1,14 +1,24 @@
 #version 330 core
 
 in vec2 TexCoords;
+in vec3 TextColor;
 
 out vec4 color;
 
 uniform sampler2D text;
-uniform vec3 textColor;
+uniform bool      distanceField;
 
 void main()
 {
-    vec4 sampled = vec4(1.0, 1.0, 1.0, texture(text, TexCoords).r);
-    color = vec4(textColor, 1.0) * sampled;
+    float alpha = texture(text, TexCoords).r;
+
+    if (distanceField)
+    {
+        // The glyph's edge lies at 0.5; antialias it over roughly one screen pixel, whatever the scale of the text
+        float smoothing = clamp(fwidth(alpha) * 0.75, 0.001, 0.5);
+        alpha = smoothstep(0.5 - smoothing, 0.5 + smoothing, alpha);
+    }
+
+    vec4 sampled = vec4(1.0, 1.0, 1.0, alpha);
+    color = vec4(TextColor, 1.0) * sampled;
 }
@@ -0,0 +1,130 @@
+/*******************************************************************
+** This code is part of Breakout.
+**
+** Breakout is free software: you can redistribute it and/or modify
+** it under the terms of the CC BY 4.0 license as published by
+** Creative Commons, either version 4 of the License, or (at your
+** option) any later version.
+******************************************************************/
+#include "audio_player.h"
+
+#include <iostream>
+
+
+// How long the audio thread sleeps when it has nothing to do
+const std::chrono::milliseconds AUDIO_THREAD_SLEEP(2);
+
+
+AudioPlayer::AudioPlayer(AudioBackend *backend)
+    : Dropped(0),
+      backend(backend),
+      running(GL_FALSE)
+{
+    for (GLint &voice : this->voices)
+        voice = -1;
+}
+
+AudioPlayer::~AudioPlayer()
+{
+    if (this->running)
+    {
+        this->running = GL_FALSE;
+        this->thread.join();
+    }
+    for (GLuint voice = 0; voice < MAX_VOICES; ++voice)
+        if (this->voices[voice] >= 0)
+            this->backend->Release(voice);
+    delete this->backend;
+}
+
+SoundHandle AudioPlayer::Load(const GLchar *file, GLuint maxVoices, GLfloat cooldown, GLboolean stream)
+{
+    if (this->running)
+        std::cout << "ERROR::AUDIOPLAYER: Sounds must be loaded before the audio thread is started: " << file << std::endl;
+    else if (!this->backend->Load(this->sounds.size(), file, stream))
+        std::cout << "ERROR::AUDIOPLAYER: Failed to load sound: " << file << std::endl;
+
+    // Sounds that failed to load still get a handle, playing them does nothing
+    Sound sound;
+    sound.MaxVoices = maxVoices;
+    sound.Cooldown = std::chrono::duration_cast<Clock::duration>(std::chrono::duration<GLfloat>(cooldown));
+    sound.Voices = 0;
+    sound.LastStart = Clock::time_point();
+    this->sounds.push_back(sound);
+    return this->sounds.size() - 1;
+}
+
+void AudioPlayer::Start()
+{
+    if (this->running)
+        return;
+    this->running = GL_TRUE;
+    this->thread = std::thread(&AudioPlayer::run, this);
+}
+
+void AudioPlayer::Play(SoundHandle sound, GLboolean loop)
+{
+    if (!this->requests.Push({ sound, loop }))
+        ++this->Dropped;
+}
+
+void AudioPlayer::run()
+{
+    while (this->running)
+    {
+        this->reclaimVoices();
+
+        PlayRequest request;
+        GLboolean idle = GL_TRUE;
+        while (this->requests.Pop(request))
+        {
+            this->start(request);
+            idle = GL_FALSE;
+        }
+        if (idle)
+            std::this_thread::sleep_for(AUDIO_THREAD_SLEEP);
+    }
+}
+
+void AudioPlayer::start(const PlayRequest &request)
+{
+    if (request.Sound >= this->sounds.size())
+        return;
+    Sound &sound = this->sounds[request.Sound];
+
+    // Enforce the limits of the sound
+    Clock::time_point now = Clock::now();
+    if (sound.Voices >= sound.MaxVoices || now - sound.LastStart < sound.Cooldown)
+    {
+        ++this->Dropped;
+        return;
+    }
+
+    // Find a free voice
+    GLuint voice = 0;
+    while (voice < MAX_VOICES && this->voices[voice] >= 0)
+        ++voice;
+    if (voice == MAX_VOICES || !this->backend->Play(voice, request.Sound, request.Loop))
+    {
+        ++this->Dropped;
+        return;
+    }
+
+    this->voices[voice] = request.Sound;
+    ++sound.Voices;
+    sound.LastStart = now;
+}
+
+void AudioPlayer::reclaimVoices()
+{
+    for (GLuint voice = 0; voice < MAX_VOICES; ++voice)
+    {
+        GLint sound = this->voices[voice];
+        if (sound >= 0 && this->backend->IsFinished(voice))
+        {
+            this->backend->Release(voice);
+            this->voices[voice] = -1;
+            --this->sounds[sound].Voices;
+        }
+    }
+}
@@ -0,0 +1,34 @@
+/*******************************************************************
+** This code is part of Breakout.
+**
+** Breakout is free software: you can redistribute it and/or modify
+** it under the terms of the CC BY 4.0 license as published by
+** Creative Commons, either version 4 of the License, or (at your
+** option) any later version.
+******************************************************************/
+#include "frame_constants.h"
+#include "shader.h"
+
+
+FrameConstantsBuffer::FrameConstantsBuffer()
+{
+    glGenBuffers(1, &this->UBO);
+    glBindBuffer(GL_UNIFORM_BUFFER, this->UBO);
+    glBufferData(GL_UNIFORM_BUFFER, sizeof(FrameConstants), NULL, GL_DYNAMIC_DRAW);
+    glBindBuffer(GL_UNIFORM_BUFFER, 0);
+
+    // Shaders connect their FrameConstants block to this binding point when they are linked
+    glBindBufferBase(GL_UNIFORM_BUFFER, FRAME_CONSTANTS_BINDING, this->UBO);
+}
+
+FrameConstantsBuffer::~FrameConstantsBuffer()
+{
+    glDeleteBuffers(1, &this->UBO);
+}
+
+void FrameConstantsBuffer::Update(const FrameConstants &constants)
+{
+    glBindBuffer(GL_UNIFORM_BUFFER, this->UBO);
+    glBufferSubData(GL_UNIFORM_BUFFER, 0, sizeof(FrameConstants), &constants);
+    glBindBuffer(GL_UNIFORM_BUFFER, 0);
+}
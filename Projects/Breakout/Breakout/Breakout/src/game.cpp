@@ -6,612 +6,478 @@
 ** Creative Commons, either version 4 of the License, or (at your
 ** option) any later version.
 ******************************************************************/
-#include <algorithm>
-#include <sstream>
+#include <cstdio>
+#include <iostream>
+#include <utility>
+#include <vector>
 
 #include <irrklang/irrKlang.h>
-using namespace irrklang;
 
 #include "game.h"
 #include "resource_manager.h"
 #include "sprite_renderer.h"
-#include "game_object.h"
-#include "ball_object.h"
+#include "level_renderer.h"
 #include "particle_generator.h"
 #include "post_processor.h"
 #include "text_renderer.h"
+#include "frame_constants.h"
+#include "profiler.h"
+#include "gl_state.h"
+#include "gpu_timer.h"
+#include "audio_player.h"
+#include "irrklang_backend.h"
 
 // Game-related State data
 SpriteRenderer *    Renderer;
-GameObject *        Player;
-BallObject *        Ball;
+LevelRenderer *     Bricks;
 ParticleGenerator * Particles;
 PostProcessor *     Effects;
-GLfloat             ShakeTime = 0.0f;
-ISoundEngine *      SoundEngine = createIrrKlangDevice();
+AudioPlayer *       Audio;
+// Sounds, loaded once by Init()
+SoundHandle         MusicSound, PaddleSound, BrickSound, SolidSound, PowerUpSound;
 TextRenderer *      Text;
+FrameConstantsBuffer * FrameUniforms;
+FrameConstants      Frame; // Uploaded to FrameUniforms at the start of every frame
+// Sprites of the simulation's objects (the objects themselves don't know how they look)
+SpriteHandle        PaddleSprite;
+SpriteHandle        BallSprite;
+std::vector<SpriteHandle> PowerUpSprites; // Indexed by PowerUpType
+TextureHandle       BackgroundTexture;
+// Positions of the balls as they are drawn (interpolated between two snapshots)
+std::vector<glm::vec2> BallPositions;
+// HUD strings whose layout is cached by Text
+TextHandle          LivesText, StartText, SelectLevelText, WinText, RetryText;
+// Passes of the effect graph (indices into Effects->Passes)
+GLuint              BlurPasses[2], EdgePass;
+// Profiler overlay (toggled with F3), its lines are only reformatted every PROFILER_OVERLAY_INTERVAL frames so they can be read
+GPUTimer *          RenderTimer;
+GLboolean           ShowProfiler = GL_FALSE;
+// (a header, one line per zone and the GL state changes of the last frame)
+const GLuint        PROFILER_LINES = NUM_PROFILE_ZONES + 2;
+TextHandle          ProfilerText[PROFILER_LINES];
+GLchar              ProfilerLines[PROFILER_LINES][64];
+GLState::Counters   FrameStateChanges[2]; // GL state changes issued and skipped during the last frame
+const GLuint        PROFILER_OVERLAY_INTERVAL = 30;
+// File the per-frame timings are written to (with F4)
+const GLchar *      PROFILE_FILE = "profile.csv";
+// The key on the keyboard each of the simulation's keys is bound to (indexed by SimulationKey)
+const GLint         KEY_BINDINGS[NUM_KEYS] = { GLFW_KEY_ENTER, GLFW_KEY_W, GLFW_KEY_S, GLFW_KEY_A, GLFW_KEY_D, GLFW_KEY_SPACE };
 
 Game::Game(GLuint width, GLuint height)
-   : State(GAME_MENU),
+   : Simulation(width, height),
      Keys(),
+     KeysProcessed(),
      Width(width),
      Height(height),
-     Level(0),
-     Lives(3)
+     running(GL_FALSE),
+     tick(0)
 {
 
 }
 
 Game::~Game()
 {
+    this->Stop();
     delete Renderer;
-    delete Player;
-    delete Ball;
+    delete Bricks;
     delete Particles;
     delete Effects;
     delete Text;
-    SoundEngine->drop();
+    delete FrameUniforms;
+    delete RenderTimer;
+    delete Audio;
 }
 
-void Game::Init()
+void Game::Init(LoadProgressCallback progress)
 {
     // Load shaders
     ResourceManager::LoadShader("shaders/sprite.vs", "shaders/sprite.frag", nullptr, "sprite");
     ResourceManager::LoadShader("shaders/particle.vs", "shaders/particle.frag", nullptr, "particle");
+    ResourceManager::LoadShader("shaders/level.vs", "shaders/level.frag", nullptr, "level");
     ResourceManager::LoadShader("shaders/post_processing.vs", "shaders/post_processing.frag", nullptr, "postprocessing");
+    ResourceManager::LoadShader("shaders/post_pass.vs", "shaders/blur.frag", nullptr, "blur");
+    ResourceManager::LoadShader("shaders/post_pass.vs", "shaders/edge.frag", nullptr, "edge");
+
+    // Configure shaders (the projection is shared by all of them through the FrameConstants block)
+    Frame.Projection = glm::ortho(0.0f,
+                                  static_cast<GLfloat>(this->Width),
+                                  static_cast<GLfloat>(this->Height),
+                                  0.0f,
+                                 -1.0f,
+                                  1.0f);
+    FrameUniforms = new FrameConstantsBuffer();
+    ResourceManager::GetShader(ResourceManager::ShaderID("sprite")).Use().SetInteger("image", 0);
+    ResourceManager::GetShader(ResourceManager::ShaderID("particle")).Use().SetInteger("sprite", 0);
+    ResourceManager::GetShader(ResourceManager::ShaderID("level")).Use().SetInteger("image", 0);
+    ResourceManager::GetShader(ResourceManager::ShaderID("level")).SetInteger("liveness", 1);
+
+    // Start decoding the textures on the worker threads, everything that doesn't need them is set up in the meantime
+    ResourceManager::LoadTextureAsync("textures/background.jpg",     GL_FALSE, "background");
+
+    // Pack all the small sprites into a shared atlas so they can be drawn without switching textures
+    ResourceManager::AddAtlasSprite("textures/awesomeface.png",         "face");
+    ResourceManager::AddAtlasSprite("textures/block.png",               "block");
+    ResourceManager::AddAtlasSprite("textures/block_solid.png",         "block_solid");
+    ResourceManager::AddAtlasSprite("textures/paddle.png",              "paddle");
+    ResourceManager::AddAtlasSprite("textures/particle.png",            "particle");
+    ResourceManager::AddAtlasSprite("textures/powerup_speed.png",       "powerup_speed");
+    ResourceManager::AddAtlasSprite("textures/powerup_sticky.png",      "powerup_sticky");
+    ResourceManager::AddAtlasSprite("textures/powerup_increase.png",    "powerup_increase");
+    ResourceManager::AddAtlasSprite("textures/powerup_confuse.png",     "powerup_confuse");
+    ResourceManager::AddAtlasSprite("textures/powerup_chaos.png",       "powerup_chaos");
+    ResourceManager::AddAtlasSprite("textures/powerup_passthrough.png", "powerup_passthrough");
+    ResourceManager::AddAtlasSprite("textures/powerup_split.png",       "powerup_split");
+
+    // Text
+    Text = new TextRenderer();
+    Text->LoadDistanceField("fonts/OCRAEXT.TTF", 24);
+    LivesText       = Text->CreateCachedText(16);
+    StartText       = Text->CreateCachedText(32);
+    SelectLevelText = Text->CreateCachedText(32);
+    WinText         = Text->CreateCachedText(16);
+    RetryText       = Text->CreateCachedText(48);
+    for (TextHandle &handle : ProfilerText)
+        handle = Text->CreateCachedText(64);
+    RenderTimer = new GPUTimer(ZONE_GPU_RENDER);
+
+    // Load levels and PowerUp types and configure game objects
+    this->Simulation.Init();
+
+    // Audio (created here rather than at static initialization, so nothing is opened before the game starts)
+    // Every sound is decoded here once, and played on the audio thread by handle (silently if there is no audio device)
+    irrklang::ISoundEngine *engine = irrklang::createIrrKlangDevice();
+    if (engine)
+        Audio = new AudioPlayer(new IrrKlangBackend(engine));
+    else
+        Audio = new AudioPlayer(new NullAudioBackend());
+    MusicSound   = Audio->Load("audio/Good_Times_by_Chic.mp3", 1, 0.0f, GL_TRUE);
+    PaddleSound  = Audio->Load("audio/bleep.wav", 2, 0.03f);
+    BrickSound   = Audio->Load("audio/bleep.mp3", 4, 0.03f); // Multiple balls can destroy dozens of bricks in a frame, a few of them are enough to hear
+    SolidSound   = Audio->Load("audio/solid.wav", 2, 0.05f);
+    PowerUpSound = Audio->Load("audio/powerup.wav", 2);
 
-    // Configure shaders
-    glm::mat4 projection = glm::ortho(0.0f,
-                                      static_cast<GLfloat>(this->Width),
-                                      static_cast<GLfloat>(this->Height),
-                                      0.0f,
-                                     -1.0f,
-                                      1.0f);
-    ResourceManager::GetShader("sprite").Use().SetInteger("image", 0);
-    ResourceManager::GetShader("sprite").SetMatrix4("projection", projection);
-    ResourceManager::GetShader("particle").Use().SetInteger("sprite", 0);
-    ResourceManager::GetShader("particle").SetMatrix4("projection", projection);
-
-    // Load textures
-    ResourceManager::LoadTexture("textures/background.jpg",          GL_FALSE, "background");
-    ResourceManager::LoadTexture("textures/awesomeface.png",         GL_TRUE,  "face");
-    ResourceManager::LoadTexture("textures/block.png",               GL_FALSE, "block");
-    ResourceManager::LoadTexture("textures/block_solid.png",         GL_FALSE, "block_solid");
-    ResourceManager::LoadTexture("textures/paddle.png",              GL_TRUE,  "paddle");
-    ResourceManager::LoadTexture("textures/particle.png",            GL_TRUE,  "particle");
-    ResourceManager::LoadTexture("textures/powerup_speed.png",       GL_TRUE, "powerup_speed");
-    ResourceManager::LoadTexture("textures/powerup_sticky.png",      GL_TRUE, "powerup_sticky");
-    ResourceManager::LoadTexture("textures/powerup_increase.png",    GL_TRUE, "powerup_increase");
-    ResourceManager::LoadTexture("textures/powerup_confuse.png",     GL_TRUE, "powerup_confuse");
-    ResourceManager::LoadTexture("textures/powerup_chaos.png",       GL_TRUE, "powerup_chaos");
-    ResourceManager::LoadTexture("textures/powerup_passthrough.png", GL_TRUE, "powerup_passthrough");
+    // Wait for the textures that are still being decoded, and pack the sprites
+    ResourceManager::FinishLoading(progress);
+    ResourceManager::BuildAtlas(2048); // A single 2048x2048 page holds all of them
 
     // Set render-specific controls
-    Renderer = new SpriteRenderer(ResourceManager::GetShader("sprite"));
-    Particles = new ParticleGenerator(ResourceManager::GetShader("particle"), ResourceManager::GetTexture("particle"), 500);
-    Effects = new PostProcessor(ResourceManager::GetShader("postprocessing"), this->Width, this->Height);
-    Text = new TextRenderer(this->Width, this->Height);
-    Text->Load("fonts/OCRAEXT.TTF", 24);
-
-    // Load levels
-    GameLevel one, two, three, four;
-    one.Load("levels/one.lvl",     this->Width, this->Height * 0.5);
-    two.Load("levels/two.lvl",     this->Width, this->Height * 0.5);
-    three.Load("levels/three.lvl", this->Width, this->Height * 0.5);
-    four.Load("levels/four.lvl",   this->Width, this->Height * 0.5);
-    this->Levels.push_back(one);
-    this->Levels.push_back(two);
-    this->Levels.push_back(three);
-    this->Levels.push_back(four);
-    this->Level = 0;
-
-    // Configure game objects
-    glm::vec2 playerPos = glm::vec2(this->Width / 2 - PLAYER_SIZE.x / 2, this->Height - PLAYER_SIZE.y);
-    Player = new GameObject(playerPos, PLAYER_SIZE, ResourceManager::GetTexture("paddle"));
-
-    glm::vec2 ballPos = playerPos + glm::vec2(PLAYER_SIZE.x / 2 - BALL_RADIUS, -BALL_RADIUS * 2);
-    Ball = new BallObject(ballPos, BALL_RADIUS, INITIAL_BALL_VELOCITY, ResourceManager::GetTexture("face"));
-
-    // Audio
-    SoundEngine->play2D("audio/Good_Times_by_Chic.mp3", GL_TRUE);
+    Renderer = new SpriteRenderer(ResourceManager::GetShader(ResourceManager::ShaderID("sprite")));
+    Bricks = new LevelRenderer(ResourceManager::GetShader(ResourceManager::ShaderID("level")), ResourceManager::GetSprite("block"), ResourceManager::GetSprite("block_solid"));
+    Particles = new ParticleGenerator(ResourceManager::GetShader(ResourceManager::ShaderID("particle")), ResourceManager::GetSprite("particle"), 500);
+    Effects = new PostProcessor(ResourceManager::GetShader(ResourceManager::ShaderID("postprocessing")), this->Width, this->Height, POSTPROCESSING_SAMPLES, POSTPROCESSING_SCALE);
+    // Shake blurs the game in two separable passes at half resolution, chaos outlines it
+    BlurPasses[0] = Effects->AddPass(ResourceManager::GetShader(ResourceManager::ShaderID("blur")), 0.5f, glm::vec2(1.0f, 0.0f));
+    BlurPasses[1] = Effects->AddPass(ResourceManager::GetShader(ResourceManager::ShaderID("blur")), 0.5f, glm::vec2(0.0f, 1.0f));
+    EdgePass      = Effects->AddPass(ResourceManager::GetShader(ResourceManager::ShaderID("edge")), 1.0f, glm::vec2(EDGE_SPREAD * POSTPROCESSING_SCALE));
+
+    // Sprites of the game objects
+    PaddleSprite = ResourceManager::SpriteID("paddle");
+    BallSprite   = ResourceManager::SpriteID("face");
+    for (const PowerUpDefinition &definition : this->Simulation.PowerUpTypes)
+        PowerUpSprites.push_back(ResourceManager::SpriteID(definition.Sprite));
+    BackgroundTexture = ResourceManager::TextureID("background");
+
+    // A misspelled name (here or in the config) would have been interned as an empty resource, without a word
+    ResourceManager::CheckLoaded();
+
+    // Everything is loaded, start the music
+    Audio->Start();
+    Audio->Play(MusicSound, GL_TRUE);
 
     //Effects->Shake = GL_TRUE;
     //Effects->Confuse = GL_TRUE;
     //Effects->Chaos = GL_TRUE;
 }
 
-void Game::Update(GLfloat dt)
+void Game::Start(const GLchar *recordFile)
 {
-    // Update objects
-    Ball->Move(dt, this->Width);
+    if (this->running)
+        return;
+
+    // Every run plays out differently, unless it is replayed from a recording with the same seed
+    GLuint64 seed = std::chrono::system_clock::now().time_since_epoch().count();
+    this->Simulation.RNG.Seed(seed);
+    if (recordFile && this->recorder.Open(recordFile, seed, SIMULATION_TICK_RATE, this->Simulation.Level))
+        std::cout << "Recording the input to " << recordFile << std::endl;
+
+    // Render has something to draw from the very first frame
+    this->publish(std::chrono::steady_clock::now());
+    this->running = GL_TRUE;
+    this->simulationThread = std::thread(&Game::runSimulation, this);
+}
 
-    // Check for collisions
-    this->DoCollisions();
+void Game::Stop()
+{
+    this->running = GL_FALSE;
+    if (this->simulationThread.joinable())
+        this->simulationThread.join();
 
-    // Update particles
-    Particles->Update(dt, *Ball, 2, glm::vec2(Ball->Radius / 2));
-   
-    // Update PowerUps
-    this->UpdatePowerUps(dt);
+    if (this->recorder.IsOpen() && this->recorder.Close(this->Simulation.StateHash()))
+        std::cout << "Recorded " << this->recorder.Ticks() << " ticks" << std::endl;
+}
 
-    // Reduce shake time
-    if (ShakeTime > 0.0f)
-    {
-        ShakeTime -= dt;
-        if (ShakeTime <= 0.0f)
-        {
-            Effects->Shake = GL_FALSE;
-        }
-    }
+void Game::runSimulation()
+{
+    typedef std::chrono::steady_clock Clock;
+    const GLfloat dt = 1.0f / SIMULATION_TICK_RATE;
+    const Clock::duration tickLength = std::chrono::duration_cast<Clock::duration>(std::chrono::duration<GLdouble>(dt));
 
-    // Check loss condition
-    if (Ball->Position.y >= this->Height)
+    Clock::time_point due = Clock::now() + tickLength;
+    while (this->running)
     {
-        --this->Lives;
+        std::this_thread::sleep_until(due);
 
-        // Game over
-        if (this->Lives == 0)
+        // Run every tick that is due, after a stall (e.g. the window being dragged) the oldest ones are dropped rather than run all at once
+        Clock::time_point now = Clock::now();
+        if (now - due > tickLength * MAX_CATCH_UP_TICKS)
+            due = now - tickLength * MAX_CATCH_UP_TICKS;
+        for (; due <= now; due += tickLength)
         {
-            this->ResetLevel();
-            this->State = GAME_MENU;
+            // The input is sampled once per tick
+            this->ProcessInput(dt);
+            this->Update(dt);
+            this->publish(due);
         }
-        this->ResetPlayer();
-    }
-
-    // Check win condition
-    if (this->State == GAME_ACTIVE && this->Levels[this->Level].IsCompleted())
-    {
-        this->ResetLevel();
-        this->ResetPlayer();
-        this->Lives = 3;
-        Effects->Chaos = GL_TRUE;
-        this->State = GAME_WIN;
     }
 }
 
-void Game::ProcessInput(GLfloat dt)
+void Game::publish(std::chrono::steady_clock::time_point time)
 {
-    if (this->State == GAME_MENU)
+    const GameSimulation &sim = this->Simulation;
+    GameSnapshot &snapshot = this->snapshots.Back();
+
+    snapshot.Tick  = ++this->tick;
+    snapshot.Time  = time;
+    snapshot.State = sim.State;
+    snapshot.Lives = sim.Lives;
+
+    // The slot still holds the bricks destroyed by the time it was filled last, only the ones destroyed since are added
+    const GameLevel &level = sim.Levels[sim.Level];
+    if (snapshot.Level != sim.Level || snapshot.LevelGeneration != level.Generation || snapshot.LevelResets != level.Resets)
+        snapshot.DestroyedCells.clear();
+    for (GLuint i = snapshot.DestroyedCells.size(); i < level.DestroyedBricks.size(); ++i)
+        snapshot.DestroyedCells.push_back(level.BrickCells[level.DestroyedBricks[i]]);
+    snapshot.Level           = sim.Level;
+    snapshot.LevelGeneration = level.Generation;
+    snapshot.LevelResets     = level.Resets;
+
+    snapshot.Player.Position = sim.Player.Position;
+    snapshot.Player.Size     = sim.Player.Size;
+    snapshot.Player.Rotation = sim.Player.Rotation;
+    snapshot.Player.Color    = sim.Player.Color;
+    snapshot.Balls.assign(sim.Balls.Positions.begin(), sim.Balls.Positions.end());
+    snapshot.BallColor = sim.BallColor;
+    snapshot.PowerUps.clear();
+    for (const PowerUp &powerUp : sim.PowerUps)
     {
-        if (this->Keys[GLFW_KEY_ENTER] && !this->KeysProcessed[GLFW_KEY_ENTER])
-        {
-            this->State = GAME_ACTIVE;
-            this->KeysProcessed[GLFW_KEY_ENTER] = GL_TRUE;
-        }
-        if (this->Keys[GLFW_KEY_W] && !this->KeysProcessed[GLFW_KEY_W])
-        {
-            this->Level = (this->Level + 1) % 4;
-            this->KeysProcessed[GLFW_KEY_W] = GL_TRUE;
-        }
-        if (this->Keys[GLFW_KEY_S] && !this->KeysProcessed[GLFW_KEY_S])
-        {
-            if (this->Level > 0)
-                --this->Level;
-            else
-                this->Level = 3;
-            this->KeysProcessed[GLFW_KEY_S] = GL_TRUE;
-        }
+        if (powerUp.Destroyed)
+            continue;
+        ObjectSnapshot object = { powerUp.Position, powerUp.Size, powerUp.Rotation, powerUp.Color, powerUp.Type };
+        snapshot.PowerUps.push_back(object);
     }
 
-    if (this->State == GAME_WIN)
-    {
-        if (this->Keys[GLFW_KEY_ENTER])
-        {
-            this->KeysProcessed[GLFW_KEY_ENTER] = GL_TRUE;
-            Effects->Chaos = GL_FALSE;
-            this->State = GAME_MENU;
-        }
-    }
+    const ParticlePool &particles = Particles->GetParticles();
+    snapshot.ParticlePositions.assign(particles.Positions.begin(), particles.Positions.begin() + particles.NumAlive);
+    snapshot.ParticleColors.assign(particles.Colors.begin(), particles.Colors.begin() + particles.NumAlive);
 
-    if (this->State == GAME_ACTIVE)
-    {
-        GLfloat velocity = PLAYER_VELOCITY * dt;
+    snapshot.Confuse = sim.Confuse;
+    snapshot.Chaos   = sim.Chaos;
+    snapshot.Shake   = sim.Shake;
 
-        // Move playerboard
-        if (this->Keys[GLFW_KEY_A])
-        {
-            if (Player->Position.x >= 0)
-            {
-                Player->Position.x -= velocity;
-                if (Ball->Stuck)
-                    Ball->Position.x -= velocity;
-            }
-        }
-        if (this->Keys[GLFW_KEY_D])
-        {
-            if (Player->Position.x <= this->Width - Player->Size.x)
-            {
-                Player->Position.x += velocity;
-                if (Ball->Stuck)
-                    Ball->Position.x += velocity;
-            }
-        }
-        if (this->Keys[GLFW_KEY_SPACE])
-        {
-            Ball->Stuck = false;
-        }
-    }
+    this->snapshots.Publish();
 }
 
-void Game::Render()
+void Game::Update(GLfloat dt)
 {
-    if (this->State == GAME_ACTIVE || this->State == GAME_MENU || this->State == GAME_WIN)
-    {
-        // Begin rendering to postprocessing quad
-        Effects->BeginRender();
-
-        Renderer->DrawSprite(ResourceManager::GetTexture("background"),
-                             glm::vec2(0, 0),
-                             glm::vec2(this->Width, this->Height),
-                             0.0f);
-        // Draw level
-        this->Levels[this->Level].Draw(*Renderer);
-
-        // Draw player
-        Player->Draw(*Renderer);
+    ProfileScope profile(ZONE_UPDATE);
+    GameSimulation &sim = this->Simulation;
 
-        // Draw PowerUps
-        for (PowerUp &powerUp : this->PowerUps)
-            if (!powerUp.Destroyed)
-                powerUp.Draw(*Renderer);
-
-        // Draw particles
-        Particles->Draw();
+    // Advance the gameplay
+    sim.Update(dt);
 
-        // Draw ball
-        Ball->Draw(*Renderer);
+    // Update particles (trailing each ball)
+    for (GLuint i = 0; i < sim.Balls.Count(); ++i)
+        Particles->Emit(sim.Balls.Positions[i], sim.Balls.Velocities[i], 2, glm::vec2(BALL_RADIUS / 2));
+    Particles->Update(dt);
 
-        // End rendering to postprocessing quad
-        Effects->EndRender();
-
-        // Render postprocessing quad
-        Effects->Render(glfwGetTime());
-
-        // Render text (don't include in postprocessing)
-        std::stringstream ss;
-        ss << this->Lives;
-        Text->RenderText("Lives:" + ss.str(), 5.0f, 5.0f, 1.0f);
-    }
-
-    if (this->State == GAME_MENU)
+    // Play the sounds of everything that happened
+    for (const SimulationEvent &event : sim.Events)
     {
-        Text->RenderText("Press ENTER to start", 250.0f, this->Height / 2, 1.0f);
-        Text->RenderText("Press W or S to select level", 245.0f, this->Height / 2 + 20.0f, 0.75f);
+        if (event.Type == PADDLE_HIT)
+            Audio->Play(PaddleSound);
+        else if (event.Type == BRICK_DESTROYED)
+            Audio->Play(BrickSound);
+        else if (event.Type == SOLID_BRICK_HIT)
+            Audio->Play(SolidSound);
+        else if (event.Type == POWERUP_ACTIVATED)
+            Audio->Play(PowerUpSound);
     }
-
-    if (this->State == GAME_WIN)
-    {
-        Text->RenderText("You WON!!!", 320.0f, this->Height / 2 - 20.0f, 1.0f, glm::vec3(0.0f, 1.0f, 0.0f));
-        Text->RenderText("Press ENTER to retry or ESC to quit", 130.0f, this->Height / 2, 1.0f, glm::vec3(1.0f, 1.0f, 0.0f));
-    }
-}
-
-void Game::ResetLevel()
-{
-    if (this->Level == 0)
-        this->Levels[0].Load("levels/one.lvl", this->Width, this->Height * 0.5f);
-    else if (this->Level == 1)
-        this->Levels[1].Load("levels/two.lvl", this->Width, this->Height * 0.5f);
-    else if (this->Level == 2)
-        this->Levels[2].Load("levels/three.lvl", this->Width, this->Height * 0.5f);
-    else if (this->Level == 3)
-        this->Levels[3].Load("levels/four.lvl", this->Width, this->Height * 0.5f);
-}
-
-void Game::ResetPlayer()
-{
-    // Reset player/ball stats
-    Player->Size = PLAYER_SIZE;
-    Player->Position = glm::vec2(this->Width / 2 - PLAYER_SIZE.x / 2, this->Height - PLAYER_SIZE.y);
-    Ball->Reset(Player->Position + glm::vec2(PLAYER_SIZE.x / 2 - BALL_RADIUS, -(BALL_RADIUS * 2)), INITIAL_BALL_VELOCITY);
-
-    // Also disable all active powerups
-    Effects->Chaos = Effects->Confuse = GL_FALSE;
-    Ball->PassThrough = Ball->Sticky = GL_FALSE;
-    Player->Color = glm::vec3(1.0f);
-    Ball->Color = glm::vec3(1.0f);
 }
 
-// PowerUps
-GLboolean IsOtherPowerUpActive(std::vector<PowerUp> &powerUps, std::string type);
-
-void Game::UpdatePowerUps(GLfloat dt)
+void Game::ProcessInput(GLfloat dt)
 {
-    for (PowerUp &powerUp : this->PowerUps)
-    {
-        powerUp.Position += powerUp.Velocity * dt;
-        if (powerUp.Activated)
-        {
-            powerUp.Duration -= dt;
+    ProfileScope profile(ZONE_PROCESS_INPUT);
 
-            if (powerUp.Duration <= 0.0f)
-            {
-                // Remove powerup from list (will later be removed)
-                powerUp.Activated = GL_FALSE;
-                // Deactivate effects
-                if (powerUp.Type == "sticky")
-                {
-                    if (!IsOtherPowerUpActive(this->PowerUps, "sticky"))
-                    {	// Only reset if no other PowerUp of type sticky is active
-                        Ball->Sticky = GL_FALSE;
-                        Player->Color = glm::vec3(1.0f);
-                    }
-                }
-                else if (powerUp.Type == "pass-through")
-                {
-                    if (!IsOtherPowerUpActive(this->PowerUps, "pass-through"))
-                    {	// Only reset if no other PowerUp of type pass-through is active
-                        Ball->PassThrough = GL_FALSE;
-                        Ball->Color = glm::vec3(1.0f);
-                    }
-                }
-                else if (powerUp.Type == "confuse")
-                {
-                    if (!IsOtherPowerUpActive(this->PowerUps, "confuse"))
-                    {	// Only reset if no other PowerUp of type confuse is active
-                        Effects->Confuse = GL_FALSE;
-                    }
-                }
-                else if (powerUp.Type == "chaos")
-                {
-                    if (!IsOtherPowerUpActive(this->PowerUps, "chaos"))
-                    {	// Only reset if no other PowerUp of type chaos is active
-                        Effects->Chaos = GL_FALSE;
-                    }
-                }
-            }
-        }
-    }
+    // Sample the keys once for the whole tick, translated to the simulation's keys
+    KeyState keys;
+    for (GLuint key = 0; key < NUM_KEYS; ++key)
+        keys[key] = this->Keys[KEY_BINDINGS[key]] != GL_FALSE;
+    if (this->recorder.IsOpen())
+        this->recorder.Record(keys);
 
-    // Remove all PowerUps from vector that are destroyed AND !activated (thus either off the map or finished)
-    // Note we use a lambda expression to remove each PowerUp which is destroyed and not activated
-    this->PowerUps.erase(std::remove_if(this->PowerUps.begin(), this->PowerUps.end(),
-        [](const PowerUp &powerUp) { return powerUp.Destroyed && !powerUp.Activated; }
-    ), this->PowerUps.end());
+    this->Simulation.ProcessInput(keys, dt);
 }
 
-GLboolean ShouldSpawn(GLuint chance)
-{
-    GLuint random = rand() % chance;
-    return random == 0;
-}
-void Game::SpawnPowerUps(GameObject &block)
+void Game::Render()
 {
-    if (ShouldSpawn(75)) // 1 in 75 chance
-        this->PowerUps.push_back(PowerUp("speed", glm::vec3(0.5f, 0.5f, 1.0f), 0.0f, block.Position, ResourceManager::GetTexture("powerup_speed")));
-    if (ShouldSpawn(75))
-        this->PowerUps.push_back(PowerUp("sticky", glm::vec3(1.0f, 0.5f, 1.0f), 20.0f, block.Position, ResourceManager::GetTexture("powerup_sticky")));
-    if (ShouldSpawn(75))
-        this->PowerUps.push_back(PowerUp("pass-through", glm::vec3(0.5f, 1.0f, 0.5f), 10.0f, block.Position, ResourceManager::GetTexture("powerup_passthrough")));
-    if (ShouldSpawn(75))
-        this->PowerUps.push_back(PowerUp("pad-size-increase", glm::vec3(1.0f, 0.6f, 0.4), 0.0f, block.Position, ResourceManager::GetTexture("powerup_increase")));
-    if (ShouldSpawn(15)) // Negative powerups should spawn more often
-        this->PowerUps.push_back(PowerUp("confuse", glm::vec3(1.0f, 0.3f, 0.3f), 15.0f, block.Position, ResourceManager::GetTexture("powerup_confuse")));
-    if (ShouldSpawn(15))
-        this->PowerUps.push_back(PowerUp("chaos", glm::vec3(0.9f, 0.25f, 0.25f), 15.0f, block.Position, ResourceManager::GetTexture("powerup_chaos")));
-}
+    ProfileScope profile(ZONE_RENDER);
+    RenderTimer->Begin();
 
-void ActivatePowerUp(PowerUp &powerUp)
-{
-    // Initiate a powerup based type of powerup
-    if (powerUp.Type == "speed")
-    {
-        Ball->Velocity *= 1.2;
-    }
-    else if (powerUp.Type == "sticky")
-    {
-        Ball->Sticky = GL_TRUE;
-        Player->Color = glm::vec3(1.0f, 0.5f, 1.0f);
-    }
-    else if (powerUp.Type == "pass-through")
+    // Keep the GL state changes of the last frame for the profiler overlay, and count this frame's from 0
+    FrameStateChanges[0] = GLState::Issued;
+    FrameStateChanges[1] = GLState::Skipped;
+    GLState::ResetCounters();
+
+    // Profiler overlay and dump (handled here rather than in ProcessInput, as the overlay belongs to the render thread)
+    if (this->Keys[GLFW_KEY_F3] && !this->KeysProcessed[GLFW_KEY_F3])
     {
-        Ball->PassThrough = GL_TRUE;
-        Ball->Color = glm::vec3(1.0f, 0.5f, 0.5f);
+        ShowProfiler = !ShowProfiler;
+        this->KeysProcessed[GLFW_KEY_F3] = GL_TRUE;
     }
-    else if (powerUp.Type == "pad-size-increase")
+    if (this->Keys[GLFW_KEY_F4] && !this->KeysProcessed[GLFW_KEY_F4])
     {
-        Player->Size.x += 50;
+        if (Profiler::WriteCSV(PROFILE_FILE))
+            std::cout << "Wrote the timings of the last " << PROFILE_HISTORY << " frames to " << PROFILE_FILE << std::endl;
+        this->KeysProcessed[GLFW_KEY_F4] = GL_TRUE;
     }
-    else if (powerUp.Type == "confuse")
+
+    // Take the latest snapshot if the simulation published one since the last frame (it is copied, so
+    // the simulation can reuse the slot; the copy reuses the storage of the snapshot it replaces)
+    if (this->snapshots.Update())
     {
-        if (!Effects->Chaos)
-            Effects->Confuse = GL_TRUE; // Only activate if chaos wasn't already active
+        std::swap(this->previous, this->current);
+        this->current = this->snapshots.Front();
     }
-    else if (powerUp.Type == "chaos")
+    const GameSnapshot &state = this->current;
+    const GameSnapshot &last = this->previous;
+
+    // Draw the moving objects in between the last two snapshots, which lags a tick behind the simulation but
+    // moves them smoothly at any frame rate (objects that appeared or disappeared, or a restart, aren't blended)
+    GLfloat alpha = 1.0f;
+    GLboolean blend = last.Tick > 0 && last.State == state.State && last.Level == state.Level && last.Lives == state.Lives;
+    if (blend)
     {
-        if (!Effects->Confuse)
-            Effects->Chaos = GL_TRUE;
+        std::chrono::duration<GLfloat> sinceTick = std::chrono::steady_clock::now() - state.Time;
+        std::chrono::duration<GLfloat> tickLength = state.Time - last.Time;
+        alpha = tickLength.count() > 0.0f ? glm::clamp(sinceTick.count() / tickLength.count(), 0.0f, 1.0f) : 1.0f;
     }
-}
 
-GLboolean IsOtherPowerUpActive(std::vector<PowerUp> &powerUps, std::string type)
-{
-    // Check if another PowerUp of the same type is still active
-    // in which case we don't disable its effect (yet)
-    for (const PowerUp &powerUp : powerUps)
+    // Show the active effects
+    GLboolean shake = state.Shake && !state.Confuse && !state.Chaos; // The other effects take precedence over the blur
+    Effects->Confuse = state.Confuse;
+    Effects->Chaos   = state.Chaos;
+    Effects->Shake   = state.Shake;
+    Effects->Passes[BlurPasses[0]].Enabled = shake;
+    Effects->Passes[BlurPasses[1]].Enabled = shake;
+    Effects->Passes[EdgePass].Enabled      = state.Chaos;
+
+    // Upload the state shared by all shaders once for the whole frame
+    Frame.Time    = glfwGetTime();
+    Frame.Confuse = Effects->Confuse;
+    Frame.Chaos   = Effects->Chaos;
+    Frame.Shake   = Effects->Shake;
+    FrameUniforms->Update(Frame);
+
+    if (state.State == GAME_ACTIVE || state.State == GAME_MENU || state.State == GAME_WIN)
     {
-        if (powerUp.Activated)
-            if (powerUp.Type == type)
-                return GL_TRUE;
-    }
-    return GL_FALSE;
-}
+        // Begin rendering to postprocessing quad (or straight to the screen while no effect is enabled)
+        Effects->BeginRender();
 
-// Collision detection
-GLboolean CheckCollision(GameObject &one, GameObject &two);
-Collision CheckCollision(BallObject &one, GameObject &two);
-Direction VectorDirection(glm::vec2 closest);
+        // Draw background
+        Renderer->Begin();
+        Renderer->Submit(ResourceManager::GetTexture(BackgroundTexture),
+                         glm::vec2(0, 0),
+                         glm::vec2(this->Width, this->Height),
+                         0.0f);
+        Renderer->Flush();
 
-void Game::DoCollisions()
-{
-    for (GameObject &box : this->Levels[this->Level].Bricks)
-    {
-        if (!box.Destroyed)
-        {
-            Collision collision = CheckCollision(*Ball, box);
+        // Draw level (a single draw call, whatever the number of bricks)
+        Bricks->Draw(this->Simulation.Levels[state.Level], state.LevelResets, state.DestroyedCells);
 
-            if (std::get<0>(collision)) // If collision is true
-            {
-                // Destroy block if not solid
-                if (!box.IsSolid)
-                {
-                    box.Destroyed = GL_TRUE;
-                    this->SpawnPowerUps(box);
-                    SoundEngine->play2D("audio/bleep.mp3", GL_FALSE);
-                }
-                else
-                {
-                    // If block is solid, enable shake effect
-                    ShakeTime = 0.05f;
-                    Effects->Shake = GL_TRUE;
-                    SoundEngine->play2D("audio/solid.wav", GL_FALSE);
-                }
-
-                // Collision resolution
-                Direction dir = std::get<1>(collision);
-                glm::vec2 diff_vector = std::get<2>(collision);
-
-                if (!(Ball->PassThrough && !box.IsSolid)) // Don't do collision resolution on non-solid bricks if pass-through activated
-                {
-                    if (dir == LEFT || dir == RIGHT) // Horizontal collision
-                    {
-                        Ball->Velocity.x = -Ball->Velocity.x; // Reverse horizontal velocity
-
-                        // Relocate
-                        GLfloat penetration = Ball->Radius - std::abs(diff_vector.x);
-                        if (dir == LEFT)
-                            Ball->Position.x += penetration; // Move ball to right
-                        else
-                            Ball->Position.x -= penetration; // Move ball to left;
-                    }
-                    else // Vertical collision
-                    {
-                        Ball->Velocity.y = -Ball->Velocity.y; // Reverse vertical velocity
-
-                        // Relocate
-                        GLfloat penetration = Ball->Radius - std::abs(diff_vector.y);
-                        if (dir == UP)
-                            Ball->Position.y -= penetration; // Move ball back up
-                        else
-                            Ball->Position.y += penetration; // Move ball back down
-                    }
-                }
-            }
-        }
-    }
+        // Batch all sprites drawn below the particles
+        Renderer->Begin();
 
-    // Also check collisions on PowerUps and if so, activate them
-    for (PowerUp &powerUp : this->PowerUps)
-    {
-        if (!powerUp.Destroyed)
-        {
-            // First check if powerup passed bottom edge, if so: keep as inactive and destroy
-            if (powerUp.Position.y >= this->Height)
-                powerUp.Destroyed = GL_TRUE;
+        // Draw player
+        glm::vec2 playerPosition = blend ? glm::mix(last.Player.Position, state.Player.Position, alpha) : state.Player.Position;
+        Renderer->Submit(ResourceManager::GetSprite(PaddleSprite), playerPosition, state.Player.Size, state.Player.Rotation, state.Player.Color);
 
-            if (CheckCollision(*Player, powerUp))
-            {
-                // Collided with player, now activate powerup
-                ActivatePowerUp(powerUp);
-                powerUp.Destroyed = GL_TRUE;
-                powerUp.Activated = GL_TRUE;
-                SoundEngine->play2D("audio/powerup.wav", GL_FALSE);
-            }
+        // Draw PowerUps
+        GLboolean blendPowerUps = blend && last.PowerUps.size() == state.PowerUps.size();
+        for (GLuint i = 0; i < state.PowerUps.size(); ++i)
+        {
+            const ObjectSnapshot &powerUp = state.PowerUps[i];
+            glm::vec2 position = blendPowerUps ? glm::mix(last.PowerUps[i].Position, powerUp.Position, alpha) : powerUp.Position;
+            Renderer->Submit(ResourceManager::GetSprite(PowerUpSprites[powerUp.Type]), position, powerUp.Size, powerUp.Rotation, powerUp.Color);
         }
-    }
 
-    // Also check for collisions between the ball and the paddle (unless stuck)
-    Collision result = CheckCollision(*Ball, *Player);
-    if (!Ball->Stuck && std::get<0>(result))
-    {
-        // Check where it hit the board, and change velocity based on where it hit the board
-        GLfloat centerBoard = Player->Position.x + Player->Size.x / 2;
-        GLfloat distance = (Ball->Position.x + Ball->Radius) - centerBoard;
-        GLfloat percentage = distance / (Player->Size.x / 2);
+        Renderer->Flush();
 
-        // Then move accordingly
-        GLfloat strength = 2.0f;
-        glm::vec2 oldVelocity = Ball->Velocity;
+        // Draw particles (they only live for a second and fade out, so they are drawn as of the last tick)
+        Particles->Draw(state.ParticlePositions.data(), state.ParticleColors.data(), state.ParticlePositions.size());
 
-        Ball->Velocity.x = INITIAL_BALL_VELOCITY.x * percentage * strength; 
-        //Ball->Velocity.y = -Ball->Velocity.y;
+        // Draw balls (a single draw call, whatever the number of balls)
+        BallPositions.assign(state.Balls.begin(), state.Balls.end());
+        if (blend && last.Balls.size() == state.Balls.size())
+            for (GLuint i = 0; i < BallPositions.size(); ++i)
+                BallPositions[i] = glm::mix(last.Balls[i], state.Balls[i], alpha);
+        Renderer->Begin();
+        Renderer->Submit(ResourceManager::GetSprite(BallSprite), BallPositions, glm::vec2(BALL_RADIUS * 2), 0.0f, state.BallColor);
+        Renderer->Flush();
 
-        // Keep speed consistent over both axes (multiply by length of old velocity, so total strength is not changed)
-        Ball->Velocity = glm::normalize(Ball->Velocity) * glm::length(oldVelocity);
-        // Fix sticky paddle
-        Ball->Velocity.y = -1 * abs(Ball->Velocity.y);
+        // End rendering to postprocessing quad
+        Effects->EndRender();
 
-        // If Sticky powerup is activated, also stick ball to paddle once new velocity vectors were calculated
-        Ball->Stuck = Ball->Sticky;
+        // Render postprocessing quad
+        Effects->Render();
 
-        SoundEngine->play2D("audio/bleep.wav", GL_FALSE);
+        // Render text (don't include in postprocessing)
+        // All strings of the frame are queued and drawn together at the end
+        Text->Begin();
+        GLchar lives[6 + 11] = "Lives:";
+        FormatInteger(state.Lives, lives + 6);
+        Text->RenderCachedText(LivesText, lives, 5.0f, 5.0f, 1.0f);
     }
-}
 
-// Check for a collision between two AABBs
-GLboolean CheckCollision(GameObject &one, GameObject &two)
-{
-    // Collision x-axis?
-    bool collisionX = one.Position.x + one.Size.x >= two.Position.x &&
-                      two.Position.x + two.Size.x >= one.Position.x;
-    // Collision y-axis?
-    bool collisionY = one.Position.y + one.Size.y >= two.Position.y &&
-                      two.Position.y + two.Size.y >= one.Position.y;
-    // Collision only if on both axes
-    return collisionX && collisionY;
-}
-
-// Check for a collision between a circle and an AABB
-Collision CheckCollision(BallObject &one, GameObject &two)
-{
-    // Calculate circle info (center)
-    glm::vec2 center(one.Position + one.Radius);
-
-    // Calculate AABB info (center, half-extents)
-    glm::vec2 aabb_half_extents(two.Size.x / 2, two.Size.y / 2);
-    glm::vec2 aabb_center(two.Position.x + aabb_half_extents.x, two.Position.y + aabb_half_extents.y);
-
-    // Get the difference vector between both centers and clamp it to the AABB's half-extents
-    glm::vec2 difference = center - aabb_center;
-    glm::vec2 clamped = glm::clamp(difference, -aabb_half_extents, aabb_half_extents);
-
-    // Add clamped value to AABB_center to get the point on the AABB's edge that is closest to the circle
-    glm::vec2 closest = aabb_center + clamped;
-
-    // Get the difference vector between the center of the circle and the closest point on the AABB's edge
-    difference = closest - center;
+    if (state.State == GAME_MENU)
+    {
+        Text->RenderCachedText(StartText, "Press ENTER to start", 250.0f, this->Height / 2, 1.0f);
+        Text->RenderCachedText(SelectLevelText, "Press W or S to select level", 245.0f, this->Height / 2 + 20.0f, 0.75f);
+    }
 
-    // Check if the distance between the center of the circle and the closest point on the AABB's edge
-    // is smaller than the radius of the circle, which would indicate a collision
-    // Note that the check is not <= since in that case a collision also occurs when object one exactly touches
-    // object two, which is the case at the end of each collision resolution stage
-    if (glm::length(difference) < one.Radius)
-        return std::make_tuple(GL_TRUE, VectorDirection(difference), difference);
-    else
-        return std::make_tuple(GL_FALSE, UP, glm::vec2(0, 0));
-}
+    if (state.State == GAME_WIN)
+    {
+        Text->RenderCachedText(WinText, "You WON!!!", 320.0f, this->Height / 2 - 20.0f, 1.0f, glm::vec3(0.0f, 1.0f, 0.0f));
+        Text->RenderCachedText(RetryText, "Press ENTER to retry or ESC to quit", 130.0f, this->Height / 2, 1.0f, glm::vec3(1.0f, 1.0f, 0.0f));
+    }
 
-// Calculates which direction a vector is facing (N, E, S or W)
-Direction VectorDirection(glm::vec2 target)
-{
-    glm::vec2 compass[] = {
-        glm::vec2(0.0f, 1.0f),  // up
-        glm::vec2(1.0f, 0.0f),  // right
-        glm::vec2(0.0f, -1.0f), // down
-        glm::vec2(-1.0f, 0.0f)  // left
-    };
-
-    GLfloat max = 0.0f;
-    GLuint best_match = -1;
-    for (GLuint i = 0; i < 4; i++)
+    if (ShowProfiler)
     {
-        GLfloat dot_product = glm::dot(glm::normalize(target), compass[i]);
-        if (dot_product > max)
+        if (Profiler::Frame() % PROFILER_OVERLAY_INTERVAL == 0 || ProfilerLines[0][0] == '\0')
         {
-            max = dot_product;
-            best_match = i;
+            std::snprintf(ProfilerLines[0], sizeof(ProfilerLines[0]), "%-14s %7s %7s %7s", "ms", "min", "avg", "p99");
+            for (GLuint zone = 0; zone < NUM_PROFILE_ZONES; ++zone)
+            {
+                ProfileStats stats = Profiler::Stats(static_cast<ProfileZone>(zone));
+                std::snprintf(ProfilerLines[zone + 1], sizeof(ProfilerLines[zone + 1]), "%-14s %7.3f %7.3f %7.3f",
+                              Profiler::ZoneName(static_cast<ProfileZone>(zone)), stats.Min, stats.Average, stats.P99);
+            }
+            std::snprintf(ProfilerLines[PROFILER_LINES - 1], sizeof(ProfilerLines[PROFILER_LINES - 1]), "%-14s %5u issued %5u skipped",
+                          "gl state", FrameStateChanges[0].Total(), FrameStateChanges[1].Total());
         }
+        for (GLuint line = 0; line < PROFILER_LINES; ++line)
+            Text->RenderCachedText(ProfilerText[line], ProfilerLines[line], 5.0f, 35.0f + line * 14.0f, 0.5f, glm::vec3(1.0f, 1.0f, 0.0f));
     }
 
-    return (Direction)best_match;
+    Text->Flush();
+    RenderTimer->End();
 }
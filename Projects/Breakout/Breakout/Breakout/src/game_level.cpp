@@ -8,90 +8,168 @@
 ******************************************************************/
 #include "game_level.h"
 
+#include <cstring>
 #include <fstream>
-#include <sstream>
+#include <iostream>
 
 
+GameLevel::GameLevel()
+    : GridWidth(0),
+      GridHeight(0),
+      Generation(0),
+      Resets(0),
+      unitWidth(0.0f),
+      unitHeight(0.0f),
+      remainingBricks(0)
+{
+
+}
+
 void GameLevel::Load(const GLchar *file, GLuint levelWidth, GLuint levelHeight)
 {
     // Clear old data
     this->Bricks.clear();
+    this->BrickCells.clear();
+    this->DestroyedBricks.clear();
+    this->cellBricks.clear();
+    this->remainingBricks = 0;
+    ++this->Generation;
 
-    // Load from file
-    std::ifstream fstream(file);
-    std::string line;
-    GLuint tileCode;
-    std::vector<std::vector<GLuint>> tileData;
+    // Read the whole file at once
+    std::ifstream fstream(file, std::ios::binary | std::ios::ate);
+    if (!fstream)
+    {
+        std::cout << "ERROR::GAMELEVEL: Failed to read level file: " << file << std::endl;
+        return;
+    }
+    std::streamsize size = fstream.tellg();
+    fstream.seekg(0);
+    this->fileData.resize(size);
+    if (size == 0 || !fstream.read(reinterpret_cast<GLchar*>(&this->fileData[0]), size))
+    {
+        std::cout << "ERROR::GAMELEVEL: Failed to read level file: " << file << std::endl;
+        return;
+    }
 
-    if (fstream)
+    // Check that it is a level this version of the game understands and that it holds everything the header promises
+    LevelFileHeader header;
+    if (size < static_cast<std::streamsize>(sizeof(header)))
     {
-        while (std::getline(fstream, line)) // Read each line from level file
-        {
-            std::istringstream sstream(line);
-            std::vector<GLuint> row;
-            while (sstream >> tileCode) // Read each word seperated by spaces
-                row.push_back(tileCode);
-            tileData.push_back(row);
-        }
+        std::cout << "ERROR::GAMELEVEL: Not a compiled level file: " << file << std::endl;
+        return;
+    }
+    std::memcpy(&header, &this->fileData[0], sizeof(header));
+    size_t paletteOffset = sizeof(header);
+    size_t tilesOffset = paletteOffset + header.NumColors * sizeof(LevelPaletteEntry);
+    if (std::memcmp(header.Magic, LEVEL_FILE_MAGIC, sizeof(header.Magic)) != 0 || header.Version != LEVEL_FILE_VERSION ||
+        header.NumColors > MAX_LEVEL_COLORS || tilesOffset + static_cast<size_t>(header.Width) * header.Height > this->fileData.size() ||
+        header.NumBricks > static_cast<size_t>(header.Width) * header.Height)
+    {
+        std::cout << "ERROR::GAMELEVEL: Not a compiled level file (or compiled by another version of levelc): " << file << std::endl;
+        return;
+    }
 
-        if (tileData.size() > 0)
-            this->init(tileData, levelWidth, levelHeight);
+    if (header.Width > 0 && header.Height > 0)
+    {
+        // The palette is copied out since the file data carries no alignment guarantees
+        LevelPaletteEntry palette[MAX_LEVEL_COLORS];
+        std::memcpy(palette, &this->fileData[paletteOffset], header.NumColors * sizeof(LevelPaletteEntry));
+        this->init(header, palette, &this->fileData[tilesOffset], levelWidth, levelHeight);
     }
 }
 
-void GameLevel::Draw(SpriteRenderer &renderer)
+void GameLevel::Reset()
 {
-    for (GameObject &tile : this->Bricks)
-        if (!tile.Destroyed)
-            tile.Draw(renderer);
+    // Bricks never move or change, so only the ones that were destroyed have to be put back
+    for (GLuint index : this->DestroyedBricks)
+    {
+        this->Bricks[index].Destroyed = GL_FALSE;
+        this->cellBricks[this->BrickCells[index]] = index;
+        if (!this->Bricks[index].IsSolid)
+            ++this->remainingBricks;
+    }
+    this->DestroyedBricks.clear();
+    ++this->Resets;
 }
 
-GLboolean GameLevel::IsCompleted()
+void GameLevel::DestroyBrick(GLuint index)
 {
-    for (GameObject &tile : this->Bricks)
-        if (!tile.IsSolid && !tile.Destroyed)
-            return GL_FALSE;
-    return GL_TRUE;
+    this->Bricks[index].Destroyed = GL_TRUE;
+    if (!this->Bricks[index].IsSolid)
+        --this->remainingBricks;
+
+    this->cellBricks[this->BrickCells[index]] = -1;
+    this->DestroyedBricks.push_back(index);
 }
 
-void GameLevel::init(std::vector<std::vector<GLuint>> tileData, GLuint levelWidth, GLuint levelHeight)
+void GameLevel::QueryBricks(glm::vec2 min, glm::vec2 max, std::vector<GLuint> &bricks) const
+{
+    bricks.clear();
+    if (this->Bricks.empty())
+        return;
+
+    // Find the range of cells overlapped by the box, skipping boxes that lie completely outside of the grid
+    GLfloat gridRight = this->GridWidth * this->unitWidth;
+    GLfloat gridBottom = this->GridHeight * this->unitHeight;
+    if (max.x < 0.0f || max.y < 0.0f || min.x >= gridRight || min.y >= gridBottom)
+        return;
+
+    GLuint firstColumn = static_cast<GLuint>(glm::max(min.x, 0.0f) / this->unitWidth);
+    GLuint firstRow    = static_cast<GLuint>(glm::max(min.y, 0.0f) / this->unitHeight);
+    GLuint lastColumn  = glm::min(static_cast<GLuint>(max.x / this->unitWidth), this->GridWidth - 1);
+    GLuint lastRow     = glm::min(static_cast<GLuint>(max.y / this->unitHeight), this->GridHeight - 1);
+
+    // Bricks were created row by row, so walking the cells in the same order keeps the indices sorted
+    for (GLuint y = firstRow; y <= lastRow; ++y)
+    {
+        for (GLuint x = firstColumn; x <= lastColumn; ++x)
+        {
+            GLint brick = this->cellBricks[y * this->GridWidth + x];
+            if (brick >= 0)
+                bricks.push_back(brick);
+        }
+    }
+}
+
+GLboolean GameLevel::IsCompleted() const
+{
+    return this->remainingBricks == 0;
+}
+
+void GameLevel::init(const LevelFileHeader &header, const LevelPaletteEntry *palette, const GLubyte *tiles, GLuint levelWidth, GLuint levelHeight)
 {
     // Calculate dimensions
-    GLuint height = tileData.size();
-    GLuint width = tileData[0].size(); // Note we can index vector at [0] since this function is only called if height > 0
+    GLuint height = header.Height;
+    GLuint width = header.Width;
     GLfloat unit_width = levelWidth / static_cast<GLfloat>(width);
     GLfloat unit_height = levelHeight / height;
+    this->GridWidth = width;
+    this->GridHeight = height;
+    this->unitWidth = unit_width;
+    this->unitHeight = unit_height;
+    this->cellBricks.assign(width * height, -1);
+    this->Bricks.reserve(header.NumBricks);
+    this->BrickCells.reserve(header.NumBricks);
+    glm::vec2 size(unit_width, unit_height);
 
-    // Initialize level tiles based on tileData
+    // Initialize level tiles based on the tile grid
     for (GLuint y = 0; y < height; ++y)
     {
         for (GLuint x = 0; x < width; ++x)
         {
-            // Check block type from level data (2D level array)
-            if (tileData[y][x] == 1) // Solid
-            {
-                glm::vec2 pos(unit_width * x, unit_height * y);
-                glm::vec2 size(unit_width, unit_height);
-                GameObject obj(pos, size, ResourceManager::GetTexture("block_solid"), glm::vec3(0.8f, 0.8f, 0.7f));
-                obj.IsSolid = GL_TRUE;
-                this->Bricks.push_back(obj);
-            }
-            else if (tileData[y][x] > 1) // Non-solid; now determine its color based on level data
-            {
-                glm::vec3 color = glm::vec3(1.0f); // original: white
-                if (tileData[y][x] == 2)
-                    color = glm::vec3(0.2f, 0.6f, 1.0f);
-                else if (tileData[y][x] == 3)
-                    color = glm::vec3(0.0f, 0.7f, 0.0f);
-                else if (tileData[y][x] == 4)
-                    color = glm::vec3(0.8f, 0.8f, 0.4f);
-                else if (tileData[y][x] == 5)
-                    color = glm::vec3(1.0f, 0.5f, 0.0f);
-
-                glm::vec2 pos(unit_width * x, unit_height * y);
-                glm::vec2 size(unit_width, unit_height);
-                this->Bricks.push_back(GameObject(pos, size, ResourceManager::GetTexture("block"), color));
-            }
+            GLuint cell = y * width + x;
+            GLuint tile = tiles[cell];
+            if (tile == 0 || tile > header.NumColors) // Empty (or a tile that isn't in the palette)
+                continue;
+
+            const LevelPaletteEntry &type = palette[tile - 1];
+            GameObject obj(glm::vec2(unit_width * x, unit_height * y), size, type.Color);
+            obj.IsSolid = type.Solid != 0;
+            if (!obj.IsSolid)
+                ++this->remainingBricks;
+            this->cellBricks[cell] = this->Bricks.size();
+            this->Bricks.push_back(obj);
+            this->BrickCells.push_back(cell);
         }
     }
 }
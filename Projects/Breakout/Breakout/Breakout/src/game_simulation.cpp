@@ -0,0 +1,754 @@
+/*******************************************************************
+** This code is part of Breakout.
+**
+** Breakout is free software: you can redistribute it and/or modify
+** it under the terms of the CC BY 4.0 license as published by
+** Creative Commons, either version 4 of the License, or (at your
+** option) any later version.
+******************************************************************/
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+#include <string>
+
+#include "game_simulation.h"
+#include "profiler.h"
+
+// Compiled level files (see levelc), in the order in which they can be selected
+const GLchar *LEVEL_FILES[] = {
+    "levels/one.blvl",
+    "levels/two.blvl",
+    "levels/three.blvl",
+    "levels/four.blvl"
+};
+// Definitions of the PowerUp types
+const GLchar *POWERUP_FILE = "config/powerups.txt";
+
+GameSimulation::GameSimulation(GLuint width, GLuint height)
+    : State(GAME_MENU),
+      Width(width),
+      Height(height),
+      Level(0),
+      Lives(INITIAL_LIVES),
+      BallColor(1.0f),
+      Sticky(GL_FALSE),
+      PassThrough(GL_FALSE),
+      Confuse(GL_FALSE),
+      Chaos(GL_FALSE),
+      Shake(GL_FALSE),
+      ShakeTime(0.0f),
+      activeEffects()
+{
+    this->PowerUps.reserve(MAX_POWERUPS);
+}
+
+void GameSimulation::Init()
+{
+    // Load levels
+    this->Levels.clear();
+    for (const GLchar *file : LEVEL_FILES)
+    {
+        this->Levels.push_back(GameLevel());
+        this->Levels.back().Load(file, this->Width, this->Height * 0.5);
+    }
+    this->Level = 0;
+
+    // Load PowerUp types
+    this->PowerUpTypes = LoadPowerUpDefinitions(POWERUP_FILE);
+
+    // Configure game objects
+    glm::vec2 playerPos = glm::vec2(this->Width / 2 - PLAYER_SIZE.x / 2, this->Height - PLAYER_SIZE.y);
+    this->Player = GameObject(playerPos, PLAYER_SIZE);
+    this->ResetPlayer();
+}
+
+void GameSimulation::ProcessInput(const KeyState &keys, GLfloat dt)
+{
+    // Menu keys only react once per press
+    KeyState pressed = keys & ~this->previousKeys;
+    this->previousKeys = keys;
+
+    if (this->State == GAME_MENU)
+    {
+        if (pressed[KEY_CONFIRM])
+            this->State = GAME_ACTIVE;
+        if (pressed[KEY_NEXT_LEVEL])
+            this->Level = (this->Level + 1) % 4;
+        if (pressed[KEY_PREVIOUS_LEVEL])
+        {
+            if (this->Level > 0)
+                --this->Level;
+            else
+                this->Level = 3;
+        }
+    }
+
+    if (this->State == GAME_WIN)
+    {
+        // Holding ENTER down doesn't start the next game right away, it has to be pressed again in the menu
+        if (keys[KEY_CONFIRM])
+        {
+            this->Chaos = GL_FALSE;
+            this->State = GAME_MENU;
+        }
+    }
+
+    if (this->State == GAME_ACTIVE)
+    {
+        // Move playerboard
+        if (keys[KEY_LEFT])
+            this->MovePlayer(-1.0f, dt);
+        if (keys[KEY_RIGHT])
+            this->MovePlayer(1.0f, dt);
+        if (keys[KEY_LAUNCH])
+            this->LaunchBalls();
+    }
+}
+
+void GameSimulation::MovePlayer(GLfloat direction, GLfloat dt)
+{
+    GLfloat velocity = PLAYER_VELOCITY * direction * dt;
+
+    // Move playerboard, as long as it stays within the window
+    if ((velocity < 0.0f && this->Player.Position.x >= 0) ||
+        (velocity > 0.0f && this->Player.Position.x <= this->Width - this->Player.Size.x))
+    {
+        this->Player.Position.x += velocity;
+        for (GLuint i = 0; i < this->Balls.Count(); ++i)
+            if (this->Balls.Stuck[i])
+                this->Balls.Positions[i].x += velocity;
+    }
+}
+
+void GameSimulation::LaunchBalls()
+{
+    std::fill(this->Balls.Stuck.begin(), this->Balls.Stuck.end(), GL_FALSE);
+}
+
+void GameSimulation::Update(GLfloat dt)
+{
+    this->Events.clear();
+
+    // Update objects
+    this->MoveBalls(dt);
+
+    // Check for collisions
+    this->DoCollisions();
+
+    // Update PowerUps
+    this->UpdatePowerUps(dt);
+
+    // Reduce shake time
+    if (this->ShakeTime > 0.0f)
+    {
+        this->ShakeTime -= dt;
+        if (this->ShakeTime <= 0.0f)
+            this->Shake = GL_FALSE;
+    }
+
+    // Check loss condition (a life is only lost once the last ball is gone)
+    this->RemoveLostBalls();
+    if (this->Balls.Count() == 0)
+    {
+        --this->Lives;
+
+        // Game over
+        if (this->Lives == 0)
+        {
+            this->ResetLevel();
+            this->State = GAME_MENU;
+        }
+        this->ResetPlayer();
+    }
+
+    // Check win condition
+    if (this->State == GAME_ACTIVE && this->Levels[this->Level].IsCompleted())
+    {
+        this->ResetLevel();
+        this->ResetPlayer();
+        this->Lives = INITIAL_LIVES;
+        this->Chaos = GL_TRUE;
+        this->State = GAME_WIN;
+    }
+}
+
+void GameSimulation::ResetLevel()
+{
+    this->Levels[this->Level].Reset();
+}
+
+GLuint64 HashBytes(GLuint64 hash, const void *data, size_t size)
+{
+    // FNV-1a
+    const GLubyte *bytes = static_cast<const GLubyte*>(data);
+    for (size_t i = 0; i < size; ++i)
+        hash = (hash ^ bytes[i]) * 0x100000001B3ull;
+    return hash;
+}
+
+template <typename T>
+GLuint64 HashValue(GLuint64 hash, const T &value)
+{
+    return HashBytes(hash, &value, sizeof(T));
+}
+
+template <typename T>
+GLuint64 HashVector(GLuint64 hash, const std::vector<T> &values)
+{
+    hash = HashValue<GLuint64>(hash, values.size());
+    return values.empty() ? hash : HashBytes(hash, &values[0], values.size() * sizeof(T));
+}
+
+GLuint64 GameSimulation::StateHash() const
+{
+    // Members are hashed one by one, so the padding between them doesn't end up in the hash
+    GLuint64 hash = 0xCBF29CE484222325ull;
+    hash = HashValue(hash, this->State);
+    hash = HashValue(hash, this->Level);
+    hash = HashValue(hash, this->Lives);
+    for (const GameLevel &level : this->Levels)
+        hash = HashVector(hash, level.DestroyedBricks);
+    hash = HashValue(hash, this->Player.Position);
+    hash = HashValue(hash, this->Player.Size);
+    hash = HashVector(hash, this->Balls.Positions);
+    hash = HashVector(hash, this->Balls.Velocities);
+    hash = HashVector(hash, this->Balls.Stuck);
+    hash = HashValue(hash, this->BallColor);
+    for (const PowerUp &powerUp : this->PowerUps)
+    {
+        hash = HashValue(hash, powerUp.Type);
+        hash = HashValue(hash, powerUp.Position);
+        hash = HashValue(hash, powerUp.Duration);
+        hash = HashValue(hash, powerUp.Activated);
+        hash = HashValue(hash, powerUp.Destroyed);
+    }
+    GLboolean flags[] = { this->Sticky, this->PassThrough, this->Confuse, this->Chaos, this->Shake };
+    hash = HashValue(hash, flags);
+    hash = HashValue(hash, this->ShakeTime);
+    hash = HashValue(hash, this->activeEffects);
+    hash = HashValue(hash, this->RNG.State());
+    return hash;
+}
+
+void GameSimulation::ResetPlayer()
+{
+    // Reset player/ball stats
+    this->Player.Size = PLAYER_SIZE;
+    this->Player.Position = glm::vec2(this->Width / 2 - PLAYER_SIZE.x / 2, this->Height - PLAYER_SIZE.y);
+    this->Balls.Clear();
+    this->Balls.Add(this->Player.Position + glm::vec2(PLAYER_SIZE.x / 2 - BALL_RADIUS, -(BALL_RADIUS * 2)), INITIAL_BALL_VELOCITY, GL_TRUE);
+
+    // Also disable all active powerups
+    for (GLuint i = 0; i < this->PowerUps.size(); )
+    {
+        if (this->PowerUps[i].Activated)
+        {
+            this->PowerUps[i] = this->PowerUps.back();
+            this->PowerUps.pop_back();
+        }
+        else
+        {
+            ++i;
+        }
+    }
+    std::fill(this->activeEffects, this->activeEffects + NUM_POWERUP_TYPES, 0);
+    this->Chaos = this->Confuse = GL_FALSE;
+    this->PassThrough = this->Sticky = GL_FALSE;
+    this->Player.Color = glm::vec3(1.0f);
+    this->BallColor = glm::vec3(1.0f);
+}
+
+// PowerUps
+// What a PowerUp does when it is activated and when its last active PowerUp of the same type runs out (either may be null)
+struct PowerUpEffect
+{
+    void (*Activate)(GameSimulation &sim);
+    void (*Deactivate)(GameSimulation &sim);
+};
+
+void ActivateSpeed(GameSimulation &sim)
+{
+    for (glm::vec2 &velocity : sim.Balls.Velocities)
+        velocity *= 1.2;
+}
+
+void ActivateSticky(GameSimulation &sim)
+{
+    sim.Sticky = GL_TRUE;
+    sim.Player.Color = glm::vec3(1.0f, 0.5f, 1.0f);
+}
+
+void DeactivateSticky(GameSimulation &sim)
+{
+    sim.Sticky = GL_FALSE;
+    sim.Player.Color = glm::vec3(1.0f);
+}
+
+void ActivatePassThrough(GameSimulation &sim)
+{
+    sim.PassThrough = GL_TRUE;
+    sim.BallColor = glm::vec3(1.0f, 0.5f, 0.5f);
+}
+
+void DeactivatePassThrough(GameSimulation &sim)
+{
+    sim.PassThrough = GL_FALSE;
+    sim.BallColor = glm::vec3(1.0f);
+}
+
+void ActivatePadSizeIncrease(GameSimulation &sim)
+{
+    sim.Player.Size.x += 50;
+}
+
+void ActivateSplit(GameSimulation &sim)
+{
+    // Every ball in play splits off new balls that fan out around its direction
+    BallPool &balls = sim.Balls;
+    GLuint count = balls.Count();
+    for (GLuint i = 0; i < count; ++i)
+    {
+        for (GLuint split = 1; split <= SPLIT_BALLS && balls.Count() < MAX_BALLS; ++split)
+        {
+            GLfloat angle = glm::radians(15.0f) * ((split + 1) / 2) * (split % 2 ? 1.0f : -1.0f);
+            glm::vec2 velocity = balls.Velocities[i];
+            velocity = glm::vec2(velocity.x * std::cos(angle) - velocity.y * std::sin(angle),
+                                 velocity.x * std::sin(angle) + velocity.y * std::cos(angle));
+            balls.Add(balls.Positions[i], velocity, balls.Stuck[i]);
+        }
+    }
+}
+
+void ActivateConfuse(GameSimulation &sim)
+{
+    if (!sim.Chaos)
+        sim.Confuse = GL_TRUE; // Only activate if chaos wasn't already active
+}
+
+void DeactivateConfuse(GameSimulation &sim)
+{
+    sim.Confuse = GL_FALSE;
+}
+
+void ActivateChaos(GameSimulation &sim)
+{
+    if (!sim.Confuse)
+        sim.Chaos = GL_TRUE;
+}
+
+void DeactivateChaos(GameSimulation &sim)
+{
+    sim.Chaos = GL_FALSE;
+}
+
+// Indexed by PowerUpType
+const PowerUpEffect POWERUP_EFFECTS[NUM_POWERUP_TYPES] = {
+    { ActivateSpeed,           nullptr },
+    { ActivateSticky,          DeactivateSticky },
+    { ActivatePassThrough,     DeactivatePassThrough },
+    { ActivatePadSizeIncrease, nullptr },
+    { ActivateSplit,           nullptr },
+    { ActivateConfuse,         DeactivateConfuse },
+    { ActivateChaos,           DeactivateChaos }
+};
+
+void GameSimulation::UpdatePowerUps(GLfloat dt)
+{
+    for (GLuint i = 0; i < this->PowerUps.size(); )
+    {
+        PowerUp &powerUp = this->PowerUps[i];
+        powerUp.Position += powerUp.Velocity * dt;
+        if (powerUp.Activated)
+        {
+            powerUp.Duration -= dt;
+
+            if (powerUp.Duration <= 0.0f)
+            {
+                // Remove powerup from list (will later be removed)
+                powerUp.Activated = GL_FALSE;
+                // Deactivate effects, but only once no other PowerUp of the same type is active
+                if (--this->activeEffects[powerUp.Type] == 0 && POWERUP_EFFECTS[powerUp.Type].Deactivate)
+                    POWERUP_EFFECTS[powerUp.Type].Deactivate(*this);
+            }
+        }
+
+        // Remove the PowerUp if it is destroyed AND !activated (thus either off the map or finished) by moving the last one into its slot
+        if (powerUp.Destroyed && !powerUp.Activated)
+        {
+            powerUp = this->PowerUps.back();
+            this->PowerUps.pop_back();
+            continue;
+        }
+        ++i;
+    }
+}
+
+GLboolean ShouldSpawn(Random &rng, GLuint chance)
+{
+    GLuint random = rng.Below(chance);
+    return random == 0;
+}
+void GameSimulation::SpawnPowerUps(GameObject &block)
+{
+    for (GLuint type = 0; type < NUM_POWERUP_TYPES; ++type)
+    {
+        const PowerUpDefinition &definition = this->PowerUpTypes[type];
+        if (definition.Chance > 0 && ShouldSpawn(this->RNG, definition.Chance) && this->PowerUps.size() < MAX_POWERUPS)
+            this->PowerUps.push_back(PowerUp(static_cast<PowerUpType>(type), definition.Color, definition.Duration, block.Position));
+    }
+}
+
+void GameSimulation::ActivatePowerUp(PowerUp &powerUp)
+{
+    ++this->activeEffects[powerUp.Type];
+    POWERUP_EFFECTS[powerUp.Type].Activate(*this);
+}
+
+// Collision detection
+GLboolean      CheckCollision(const GameObject &one, const GameObject &two);
+Collision      CheckCollision(glm::vec2 center, GLfloat radius, const GameObject &two);
+SweptCollision CheckCollision(glm::vec2 center, GLfloat radius, glm::vec2 motion, const GameObject &two);
+Direction      VectorDirection(glm::vec2 closest);
+
+void GameSimulation::MoveBalls(GLfloat dt)
+{
+    ProfileScope profile(ZONE_COLLISIONS); // Moving the balls is mostly finding what they collide with
+    BallPool &balls = this->Balls;
+    this->ballTimeLeft.assign(balls.Count(), dt);
+
+    // Each pass moves every ball up to the first thing it runs into and bounces it off, until all balls used up the whole timestep.
+    // Hits are found for all balls at once from the state at the start of the pass and then resolved one by one in the order
+    // of the balls. This is not split over cores: a whole tick with 400 balls takes about 45us (under 1% of a 120 Hz tick),
+    // and handing up to MAX_BALL_COLLISIONS passes per tick to other threads and waiting for them costs more than it saves
+    // (starting worker threads per pass halved the tick rate).
+    for (GLuint pass = 0; pass < MAX_BALL_COLLISIONS; ++pass)
+    {
+        this->movingBalls.clear();
+        for (GLuint i = 0; i < balls.Count(); ++i)
+            if (!balls.Stuck[i] && this->ballTimeLeft[i] > 0.0f)
+                this->movingBalls.push_back(i);
+        if (this->movingBalls.empty())
+            break;
+
+        // Find the earliest hit of each ball
+        this->ballHits.resize(this->movingBalls.size());
+        for (GLuint i = 0; i < this->movingBalls.size(); ++i)
+        {
+            GLuint ball = this->movingBalls[i];
+            this->ballHits[i] = this->FindBallHit(ball, this->ballTimeLeft[ball], this->nearbyBricks);
+        }
+
+        // Move the balls up to their hits and bounce them off
+        for (GLuint i = 0; i < this->movingBalls.size(); ++i)
+        {
+            GLuint ball = this->movingBalls[i];
+            const BallHit &hit = this->ballHits[i];
+            glm::vec2 motion = balls.Velocities[ball] * this->ballTimeLeft[ball];
+
+            // Nothing in the way, so the ball can use up the rest of the timestep
+            if (!hit.Hit)
+            {
+                balls.Positions[ball] += motion;
+                this->ballTimeLeft[ball] = 0.0f;
+                continue;
+            }
+
+            balls.Positions[ball] += motion * hit.Time;
+            this->ballTimeLeft[ball] *= 1.0f - hit.Time;
+            this->ResolveBallHit(ball, hit);
+        }
+    }
+}
+
+BallHit GameSimulation::FindBallHit(GLuint ball, GLfloat time, std::vector<GLuint> &nearbyBricks) const
+{
+    const GameLevel &level = this->Levels[this->Level];
+    glm::vec2 position = this->Balls.Positions[ball];
+    glm::vec2 motion = this->Balls.Velocities[ball] * time;
+    glm::vec2 center = position + BALL_RADIUS;
+    glm::vec2 size(BALL_RADIUS * 2);
+
+    // Earliest collision along the motion
+    BallHit hit = { 1.0f, glm::vec2(0.0f), -1, GL_FALSE, GL_FALSE };
+    auto record = [&](GLfloat time, glm::vec2 normal, GLint brick, GLboolean player)
+    {
+        time = glm::max(time, 0.0f);
+        if (time <= 1.0f && (!hit.Hit || time < hit.Time))
+        {
+            hit.Hit = GL_TRUE;
+            hit.Time = time;
+            hit.Normal = normal;
+            hit.Brick = brick;
+            hit.Player = player;
+        }
+    };
+
+    // Window edges (except the bottom edge)
+    if (motion.x < 0.0f)
+        record(-position.x / motion.x, glm::vec2(1.0f, 0.0f), -1, GL_FALSE);
+    else if (motion.x > 0.0f)
+        record((this->Width - size.x - position.x) / motion.x, glm::vec2(-1.0f, 0.0f), -1, GL_FALSE);
+    if (motion.y < 0.0f)
+        record(-position.y / motion.y, glm::vec2(0.0f, 1.0f), -1, GL_FALSE);
+
+    // Bricks in the grid cells the ball sweeps over
+    glm::vec2 end = position + motion;
+    level.QueryBricks(glm::min(position, end), glm::max(position, end) + size, nearbyBricks);
+    for (GLuint i : nearbyBricks)
+    {
+        SweptCollision collision = CheckCollision(center, BALL_RADIUS, motion, level.Bricks[i]);
+        if (std::get<0>(collision))
+            record(std::get<1>(collision), std::get<2>(collision), i, GL_FALSE);
+    }
+
+    // Player paddle
+    SweptCollision collision = CheckCollision(center, BALL_RADIUS, motion, this->Player);
+    if (std::get<0>(collision))
+        record(std::get<1>(collision), std::get<2>(collision), -1, GL_TRUE);
+
+    return hit;
+}
+
+void GameSimulation::ResolveBallHit(GLuint ball, const BallHit &hit)
+{
+    glm::vec2 &position = this->Balls.Positions[ball];
+    glm::vec2 &velocity = this->Balls.Velocities[ball];
+
+    if (hit.Player)
+    {
+        // Check where it hit the board, and change velocity based on where it hit the board
+        GLfloat centerBoard = this->Player.Position.x + this->Player.Size.x / 2;
+        GLfloat distance = (position.x + BALL_RADIUS) - centerBoard;
+        GLfloat percentage = distance / (this->Player.Size.x / 2);
+
+        // Then move accordingly
+        GLfloat strength = 2.0f;
+        glm::vec2 oldVelocity = velocity;
+
+        velocity.x = INITIAL_BALL_VELOCITY.x * percentage * strength;
+
+        // Keep speed consistent over both axes (multiply by length of old velocity, so total strength is not changed)
+        velocity = glm::normalize(velocity) * glm::length(oldVelocity);
+        // Always bounce upwards
+        velocity.y = -1 * std::abs(velocity.y);
+
+        // If Sticky powerup is activated, also stick ball to paddle once new velocity vectors were calculated
+        this->Balls.Stuck[ball] = this->Sticky;
+
+        this->Events.push_back({ PADDLE_HIT, position });
+        return;
+    }
+
+    if (hit.Brick >= 0)
+    {
+        GameLevel &level = this->Levels[this->Level];
+        GameObject &box = level.Bricks[hit.Brick];
+
+        // Another ball destroyed the brick earlier in this pass, so the ball just carries on in the next one
+        if (box.Destroyed)
+            return;
+
+        // Destroy block if not solid
+        if (!box.IsSolid)
+        {
+            level.DestroyBrick(hit.Brick);
+            this->SpawnPowerUps(box);
+            this->Events.push_back({ BRICK_DESTROYED, box.Position });
+        }
+        else
+        {
+            // If block is solid, enable shake effect
+            this->ShakeTime = 0.05f;
+            this->Shake = GL_TRUE;
+            this->Events.push_back({ SOLID_BRICK_HIT, box.Position });
+        }
+
+        // Don't bounce off non-solid bricks if pass-through is activated
+        if (this->PassThrough && !box.IsSolid)
+            return;
+    }
+
+    // Reflect the velocity on the surface that was hit
+    velocity -= 2.0f * glm::dot(velocity, hit.Normal) * hit.Normal;
+}
+
+void GameSimulation::RemoveLostBalls()
+{
+    // Compact the remaining balls, keeping them in the same order
+    BallPool &balls = this->Balls;
+    GLuint kept = 0;
+    for (GLuint i = 0; i < balls.Count(); ++i)
+    {
+        if (balls.Positions[i].y >= this->Height)
+            continue;
+
+        balls.Positions[kept] = balls.Positions[i];
+        balls.Velocities[kept] = balls.Velocities[i];
+        balls.Stuck[kept] = balls.Stuck[i];
+        ++kept;
+    }
+    balls.Positions.resize(kept);
+    balls.Velocities.resize(kept);
+    balls.Stuck.resize(kept);
+}
+
+void GameSimulation::DoCollisions()
+{
+    ProfileScope profile(ZONE_COLLISIONS);
+    // Check collisions on PowerUps and if so, activate them
+    for (PowerUp &powerUp : this->PowerUps)
+    {
+        if (!powerUp.Destroyed)
+        {
+            // First check if powerup passed bottom edge, if so: keep as inactive and destroy
+            if (powerUp.Position.y >= this->Height)
+                powerUp.Destroyed = GL_TRUE;
+
+            if (CheckCollision(this->Player, powerUp))
+            {
+                // Collided with player, now activate powerup
+                this->ActivatePowerUp(powerUp);
+                powerUp.Destroyed = GL_TRUE;
+                powerUp.Activated = GL_TRUE;
+                this->Events.push_back({ POWERUP_ACTIVATED, powerUp.Position });
+            }
+        }
+    }
+}
+
+// Check for a collision between two AABBs
+GLboolean CheckCollision(const GameObject &one, const GameObject &two)
+{
+    // Collision x-axis?
+    bool collisionX = one.Position.x + one.Size.x >= two.Position.x &&
+                      two.Position.x + two.Size.x >= one.Position.x;
+    // Collision y-axis?
+    bool collisionY = one.Position.y + one.Size.y >= two.Position.y &&
+                      two.Position.y + two.Size.y >= one.Position.y;
+    // Collision only if on both axes
+    return collisionX && collisionY;
+}
+
+// Check for a collision between a circle and an AABB
+Collision CheckCollision(glm::vec2 center, GLfloat radius, const GameObject &two)
+{
+    // Calculate AABB info (center, half-extents)
+    glm::vec2 aabb_half_extents(two.Size.x / 2, two.Size.y / 2);
+    glm::vec2 aabb_center(two.Position.x + aabb_half_extents.x, two.Position.y + aabb_half_extents.y);
+
+    // Get the difference vector between both centers and clamp it to the AABB's half-extents
+    glm::vec2 difference = center - aabb_center;
+    glm::vec2 clamped = glm::clamp(difference, -aabb_half_extents, aabb_half_extents);
+
+    // Add clamped value to AABB_center to get the point on the AABB's edge that is closest to the circle
+    glm::vec2 closest = aabb_center + clamped;
+
+    // Get the difference vector between the center of the circle and the closest point on the AABB's edge
+    difference = closest - center;
+
+    // Check if the distance between the center of the circle and the closest point on the AABB's edge
+    // is smaller than the radius of the circle, which would indicate a collision
+    // Note that the check is not <= since in that case a collision also occurs when object one exactly touches
+    // object two, which is the case at the end of each collision resolution stage
+    if (glm::length(difference) < radius)
+        return std::make_tuple(GL_TRUE, VectorDirection(difference), difference);
+    else
+        return std::make_tuple(GL_FALSE, UP, glm::vec2(0, 0));
+}
+
+// Sweeps a circle along the given motion and finds the earliest time at which it touches an AABB
+SweptCollision CheckCollision(glm::vec2 center, GLfloat radius, glm::vec2 motion, const GameObject &two)
+{
+    glm::vec2 boxMin(two.Position);
+    glm::vec2 boxMax(two.Position + two.Size);
+
+    // Already overlapping (e.g. the paddle moved into the ball), so collide right away unless the ball is moving away
+    Collision overlap = CheckCollision(center, radius, two);
+    if (std::get<0>(overlap))
+    {
+        glm::vec2 difference = std::get<2>(overlap);
+        glm::vec2 normal = glm::length(difference) > 0.0f ? -glm::normalize(difference) : glm::vec2(0.0f, -1.0f);
+        if (glm::dot(motion, normal) < 0.0f)
+            return std::make_tuple(GL_TRUE, 0.0f, normal);
+        return std::make_tuple(GL_FALSE, 0.0f, glm::vec2(0, 0));
+    }
+
+    GLboolean hit = GL_FALSE;
+    GLfloat   time = 1.0f;
+    glm::vec2 normal(0.0f);
+
+    // Faces: the center has to reach the face pushed out by the radius, while staying between the face's corners
+    for (GLuint axis = 0; axis < 2; ++axis)
+    {
+        if (motion[axis] == 0.0f)
+            continue;
+
+        GLuint  other = 1 - axis;
+        GLfloat face = motion[axis] > 0.0f ? boxMin[axis] - radius : boxMax[axis] + radius;
+        GLfloat t = (face - center[axis]) / motion[axis];
+        if (t < 0.0f || t > time)
+            continue;
+
+        GLfloat along = center[other] + motion[other] * t;
+        if (along < boxMin[other] || along > boxMax[other])
+            continue;
+
+        hit = GL_TRUE;
+        time = t;
+        normal = glm::vec2(0.0f);
+        normal[axis] = motion[axis] > 0.0f ? -1.0f : 1.0f;
+    }
+
+    // Corners: the center has to come within the radius of the corner
+    glm::vec2 corners[] = { boxMin, glm::vec2(boxMax.x, boxMin.y), boxMax, glm::vec2(boxMin.x, boxMax.y) };
+    GLfloat a = glm::dot(motion, motion);
+    for (const glm::vec2 &corner : corners)
+    {
+        glm::vec2 offset = center - corner;
+        GLfloat b = glm::dot(offset, motion);
+        if (b >= 0.0f) // Moving away from the corner
+            continue;
+
+        GLfloat c = glm::dot(offset, offset) - radius * radius;
+        GLfloat discriminant = b * b - a * c;
+        if (discriminant < 0.0f)
+            continue;
+
+        GLfloat t = (-b - std::sqrt(discriminant)) / a;
+        if (t < 0.0f || t > time)
+            continue;
+
+        hit = GL_TRUE;
+        time = t;
+        normal = (offset + motion * t) / radius;
+    }
+
+    if (hit)
+        return std::make_tuple(GL_TRUE, time, normal);
+    return std::make_tuple(GL_FALSE, 0.0f, glm::vec2(0, 0));
+}
+
+// Calculates which direction a vector is facing (N, E, S or W)
+Direction VectorDirection(glm::vec2 target)
+{
+    glm::vec2 compass[] = {
+        glm::vec2(0.0f, 1.0f),  // up
+        glm::vec2(1.0f, 0.0f),  // right
+        glm::vec2(0.0f, -1.0f), // down
+        glm::vec2(-1.0f, 0.0f)  // left
+    };
+
+    GLfloat max = 0.0f;
+    GLuint best_match = -1;
+    for (GLuint i = 0; i < 4; i++)
+    {
+        GLfloat dot_product = glm::dot(glm::normalize(target), compass[i]);
+        if (dot_product > max)
+        {
+            max = dot_product;
+            best_match = i;
+        }
+    }
+
+    return (Direction)best_match;
+}
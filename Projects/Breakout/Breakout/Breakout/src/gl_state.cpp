@@ -0,0 +1,175 @@
+/*******************************************************************
+** This code is part of Breakout.
+**
+** Breakout is free software: you can redistribute it and/or modify
+** it under the terms of the CC BY 4.0 license as published by
+** Creative Commons, either version 4 of the License, or (at your
+** option) any later version.
+******************************************************************/
+#include "gl_state.h"
+
+
+// Marks a piece of shadowed state as unknown, no real value ever compares equal to it
+static const GLuint UNKNOWN_STATE = 0xFFFFFFFF;
+
+// Instantiate static variables
+GLState::Counters GLState::Issued  = { };
+GLState::Counters GLState::Skipped = { };
+GLuint            GLState::program     = UNKNOWN_STATE;
+GLuint            GLState::vertexArray = UNKNOWN_STATE;
+GLuint            GLState::activeUnit  = UNKNOWN_STATE;
+GLuint            GLState::textures[MAX_TRACKED_TEXTURE_UNITS] = { UNKNOWN_STATE, UNKNOWN_STATE, UNKNOWN_STATE, UNKNOWN_STATE,
+                                                                   UNKNOWN_STATE, UNKNOWN_STATE, UNKNOWN_STATE, UNKNOWN_STATE,
+                                                                   UNKNOWN_STATE, UNKNOWN_STATE, UNKNOWN_STATE, UNKNOWN_STATE,
+                                                                   UNKNOWN_STATE, UNKNOWN_STATE, UNKNOWN_STATE, UNKNOWN_STATE };
+GLenum            GLState::blendSource      = UNKNOWN_STATE;
+GLenum            GLState::blendDestination = UNKNOWN_STATE;
+GLuint            GLState::capabilities[3]  = { UNKNOWN_STATE, UNKNOWN_STATE, UNKNOWN_STATE };
+
+
+void GLState::UseProgram(GLuint program)
+{
+    if (program == GLState::program)
+    {
+        ++Skipped.Programs;
+        return;
+    }
+
+    glUseProgram(program);
+    GLState::program = program;
+    ++Issued.Programs;
+}
+
+void GLState::BindVertexArray(GLuint vertexArray)
+{
+    if (vertexArray == GLState::vertexArray)
+    {
+        ++Skipped.VertexArrays;
+        return;
+    }
+
+    glBindVertexArray(vertexArray);
+    GLState::vertexArray = vertexArray;
+    ++Issued.VertexArrays;
+}
+
+void GLState::ActiveTexture(GLuint unit)
+{
+    if (unit == activeUnit)
+    {
+        ++Skipped.ActiveTextures;
+        return;
+    }
+
+    glActiveTexture(GL_TEXTURE0 + unit);
+    activeUnit = unit;
+    ++Issued.ActiveTextures;
+}
+
+void GLState::BindTexture(GLuint texture)
+{
+    // Bindings of units we don't track (or of an unknown unit) are always forwarded
+    GLboolean tracked = activeUnit < MAX_TRACKED_TEXTURE_UNITS;
+    if (tracked && textures[activeUnit] == texture)
+    {
+        ++Skipped.Textures;
+        return;
+    }
+
+    glBindTexture(GL_TEXTURE_2D, texture);
+    if (tracked)
+        textures[activeUnit] = texture;
+    ++Issued.Textures;
+}
+
+void GLState::BlendFunc(GLenum sourceFactor, GLenum destinationFactor)
+{
+    if (sourceFactor == blendSource && destinationFactor == blendDestination)
+    {
+        ++Skipped.BlendFuncs;
+        return;
+    }
+
+    glBlendFunc(sourceFactor, destinationFactor);
+    blendSource = sourceFactor;
+    blendDestination = destinationFactor;
+    ++Issued.BlendFuncs;
+}
+
+void GLState::Enable(GLenum capability)
+{
+    setCapability(capability, GL_TRUE);
+}
+
+void GLState::Disable(GLenum capability)
+{
+    setCapability(capability, GL_FALSE);
+}
+
+void GLState::DeleteProgram(GLuint program)
+{
+    if (program == GLState::program)
+        GLState::program = 0;
+    glDeleteProgram(program);
+}
+
+void GLState::DeleteVertexArray(GLuint vertexArray)
+{
+    if (vertexArray == GLState::vertexArray)
+        GLState::vertexArray = 0;
+    glDeleteVertexArrays(1, &vertexArray);
+}
+
+void GLState::DeleteTexture(GLuint texture)
+{
+    // The texture is unbound from every unit it is bound to
+    for (GLuint unit = 0; unit < MAX_TRACKED_TEXTURE_UNITS; ++unit)
+        if (textures[unit] == texture)
+            textures[unit] = 0;
+    glDeleteTextures(1, &texture);
+}
+
+void GLState::Invalidate()
+{
+    program = UNKNOWN_STATE;
+    vertexArray = UNKNOWN_STATE;
+    activeUnit = UNKNOWN_STATE;
+    for (GLuint unit = 0; unit < MAX_TRACKED_TEXTURE_UNITS; ++unit)
+        textures[unit] = UNKNOWN_STATE;
+    blendSource = UNKNOWN_STATE;
+    blendDestination = UNKNOWN_STATE;
+    for (GLuint i = 0; i < 3; ++i)
+        capabilities[i] = UNKNOWN_STATE;
+}
+
+void GLState::ResetCounters()
+{
+    Issued = Counters();
+    Skipped = Counters();
+}
+
+void GLState::setCapability(GLenum capability, GLboolean enabled)
+{
+    GLint index = -1;
+    switch (capability)
+    {
+    case GL_BLEND:      index = 0; break;
+    case GL_DEPTH_TEST: index = 1; break;
+    case GL_CULL_FACE:  index = 2; break;
+    }
+
+    // Capabilities we don't track are always forwarded
+    if (index >= 0 && capabilities[index] == enabled)
+    {
+        ++Skipped.Capabilities;
+        return;
+    }
+
+    if (enabled)
+        glEnable(capability);
+    else
+        glDisable(capability);
+    if (index >= 0)
+        capabilities[index] = enabled;
+    ++Issued.Capabilities;
+}
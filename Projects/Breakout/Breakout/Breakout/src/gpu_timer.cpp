@@ -0,0 +1,68 @@
+/*******************************************************************
+** This code is part of Breakout.
+**
+** Breakout is free software: you can redistribute it and/or modify
+** it under the terms of the CC BY 4.0 license as published by
+** Creative Commons, either version 4 of the License, or (at your
+** option) any later version.
+******************************************************************/
+#include "gpu_timer.h"
+
+
+GPUTimer::GPUTimer(ProfileZone zone)
+    : zone(zone),
+      frames(),
+      pending(),
+      next(0),
+      timing(GL_FALSE)
+{
+    glGenQueries(GPU_TIMER_QUERIES, this->queries);
+}
+
+GPUTimer::~GPUTimer()
+{
+    glDeleteQueries(GPU_TIMER_QUERIES, this->queries);
+}
+
+void GPUTimer::Begin()
+{
+    this->collect();
+
+    // Skip the frame rather than wait when the GPU is so far behind that the next query is still in flight
+    this->timing = Profiler::Enabled && !this->pending[this->next];
+    if (this->timing)
+        glBeginQuery(GL_TIME_ELAPSED, this->queries[this->next]);
+}
+
+void GPUTimer::End()
+{
+    if (!this->timing)
+        return;
+
+    glEndQuery(GL_TIME_ELAPSED);
+    this->frames[this->next] = Profiler::Frame();
+    this->pending[this->next] = GL_TRUE;
+    this->next = (this->next + 1) % GPU_TIMER_QUERIES;
+    this->timing = GL_FALSE;
+}
+
+void GPUTimer::collect()
+{
+    // Queries complete in the order they were issued, so stop at the first one that isn't available yet
+    for (GLuint i = 0; i < GPU_TIMER_QUERIES; ++i)
+    {
+        GLuint query = (this->next + i) % GPU_TIMER_QUERIES;
+        if (!this->pending[query])
+            continue;
+
+        GLint available = 0;
+        glGetQueryObjectiv(this->queries[query], GL_QUERY_RESULT_AVAILABLE, &available);
+        if (!available)
+            break;
+
+        GLuint64 nanoseconds = 0;
+        glGetQueryObjectui64v(this->queries[query], GL_QUERY_RESULT, &nanoseconds);
+        Profiler::Record(this->zone, this->frames[query], nanoseconds / 1000000.0);
+        this->pending[query] = GL_FALSE;
+    }
+}
@@ -0,0 +1,199 @@
+/*******************************************************************
+** This code is part of Breakout.
+**
+** Breakout is free software: you can redistribute it and/or modify
+** it under the terms of the CC BY 4.0 license as published by
+** Creative Commons, either version 4 of the License, or (at your
+** option) any later version.
+******************************************************************/
+#include "input_recording.h"
+
+#include <cstring>
+#include <iostream>
+
+
+InputRecorder::InputRecorder()
+    : ticks(0), lastEvent(0)
+{
+
+}
+
+GLboolean InputRecorder::Open(const GLchar *file, GLuint64 seed, GLuint tickRate, GLuint level)
+{
+    this->file.open(file, std::ios::binary | std::ios::trunc);
+    if (!this->file)
+    {
+        std::cout << "ERROR::INPUTRECORDER: Failed to create recording: " << file << std::endl;
+        return GL_FALSE;
+    }
+
+    RecordingHeader header;
+    std::memcpy(header.Magic, RECORDING_MAGIC, sizeof(header.Magic));
+    header.Version = RECORDING_VERSION;
+    header.Seed = seed;
+    header.TickRate = tickRate;
+    header.Level = level;
+    this->file.write(reinterpret_cast<const GLchar*>(&header), sizeof(header));
+
+    // Every key starts out up
+    this->keys.reset();
+    this->ticks = 0;
+    this->lastEvent = 0;
+    return GL_TRUE;
+}
+
+GLboolean InputRecorder::IsOpen() const
+{
+    return this->file.is_open();
+}
+
+void InputRecorder::Record(const KeyState &keys)
+{
+    ++this->ticks;
+    KeyState changed = keys ^ this->keys;
+    if (changed.none())
+        return;
+
+    for (GLuint key = 0; key < NUM_KEYS; ++key)
+        if (changed[key])
+            this->writeEvent(key << 1 | (keys[key] ? 1 : 0));
+    this->keys = keys;
+}
+
+GLboolean InputRecorder::Close(GLuint64 stateHash)
+{
+    if (!this->file.is_open())
+        return GL_FALSE;
+
+    this->writeEvent(RECORDING_END);
+    this->file.write(reinterpret_cast<const GLchar*>(&stateHash), sizeof(stateHash));
+    GLboolean written = static_cast<GLboolean>(this->file.good());
+    this->file.close();
+    if (!written)
+        std::cout << "ERROR::INPUTRECORDER: Failed to write recording" << std::endl;
+    return written;
+}
+
+GLuint64 InputRecorder::Ticks() const
+{
+    return this->ticks;
+}
+
+void InputRecorder::writeEvent(GLuint key)
+{
+    this->writeVarint(this->ticks - this->lastEvent);
+    this->writeVarint(key);
+    this->lastEvent = this->ticks;
+}
+
+void InputRecorder::writeVarint(GLuint64 value)
+{
+    GLubyte bytes[10];
+    GLuint count = 0;
+    do
+    {
+        bytes[count] = value & 0x7F;
+        value >>= 7;
+        if (value != 0)
+            bytes[count] |= 0x80; // More bytes follow
+        ++count;
+    } while (value != 0);
+    this->file.write(reinterpret_cast<const GLchar*>(bytes), count);
+}
+
+
+InputReplayer::InputReplayer()
+    : Ticks(0), StateHash(0), cursor(0), tick(0), nextTick(0), nextKey(RECORDING_END)
+{
+
+}
+
+GLboolean InputReplayer::Open(const GLchar *file)
+{
+    // Read the whole file at once
+    std::ifstream fstream(file, std::ios::binary | std::ios::ate);
+    if (!fstream)
+    {
+        std::cout << "ERROR::INPUTREPLAYER: Failed to read recording: " << file << std::endl;
+        return GL_FALSE;
+    }
+    std::streamsize size = fstream.tellg();
+    fstream.seekg(0);
+    this->data.resize(size);
+    if (size < static_cast<std::streamsize>(sizeof(RecordingHeader)) || !fstream.read(reinterpret_cast<GLchar*>(&this->data[0]), size))
+    {
+        std::cout << "ERROR::INPUTREPLAYER: Not an input recording: " << file << std::endl;
+        return GL_FALSE;
+    }
+    std::memcpy(&this->Header, &this->data[0], sizeof(this->Header));
+    if (std::memcmp(this->Header.Magic, RECORDING_MAGIC, sizeof(this->Header.Magic)) != 0 || this->Header.Version != RECORDING_VERSION || this->Header.TickRate == 0)
+    {
+        std::cout << "ERROR::INPUTREPLAYER: Not an input recording (or recorded by another version of the game): " << file << std::endl;
+        return GL_FALSE;
+    }
+
+    // Run through the events once to find the end, so a truncated recording is caught before anything is replayed
+    this->cursor = sizeof(this->Header);
+    this->nextTick = 0;
+    do
+    {
+        if (!this->readEvent())
+        {
+            std::cout << "ERROR::INPUTREPLAYER: Recording is incomplete: " << file << std::endl;
+            return GL_FALSE;
+        }
+    } while (this->nextKey != RECORDING_END);
+    if (this->cursor + sizeof(this->StateHash) > this->data.size())
+    {
+        std::cout << "ERROR::INPUTREPLAYER: Recording is incomplete: " << file << std::endl;
+        return GL_FALSE;
+    }
+    this->Ticks = this->nextTick;
+    std::memcpy(&this->StateHash, &this->data[this->cursor], sizeof(this->StateHash));
+
+    // Rewind to the first event
+    this->cursor = sizeof(this->Header);
+    this->nextTick = 0;
+    this->readEvent();
+    this->keys.reset();
+    this->tick = 0;
+    return GL_TRUE;
+}
+
+GLboolean InputReplayer::Next(KeyState &keys)
+{
+    if (this->tick == this->Ticks)
+        return GL_FALSE;
+    ++this->tick;
+
+    // Apply every key that changed in this tick
+    while (this->nextTick == this->tick && this->nextKey != RECORDING_END)
+    {
+        this->keys[this->nextKey >> 1] = (this->nextKey & 1) != 0;
+        this->readEvent();
+    }
+    keys = this->keys;
+    return GL_TRUE;
+}
+
+GLboolean InputReplayer::readEvent()
+{
+    GLuint64 delta;
+    if (!this->readVarint(delta) || !this->readVarint(this->nextKey) || this->nextKey > RECORDING_END)
+        return GL_FALSE;
+    this->nextTick += delta;
+    return GL_TRUE;
+}
+
+GLboolean InputReplayer::readVarint(GLuint64 &value)
+{
+    value = 0;
+    for (GLuint shift = 0; shift < 64 && this->cursor < this->data.size(); shift += 7)
+    {
+        GLubyte byte = this->data[this->cursor++];
+        value |= static_cast<GLuint64>(byte & 0x7F) << shift;
+        if (!(byte & 0x80))
+            return GL_TRUE;
+    }
+    return GL_FALSE;
+}
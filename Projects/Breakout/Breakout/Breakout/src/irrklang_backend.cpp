@@ -0,0 +1,60 @@
+/*******************************************************************
+** This code is part of Breakout.
+**
+** Breakout is free software: you can redistribute it and/or modify
+** it under the terms of the CC BY 4.0 license as published by
+** Creative Commons, either version 4 of the License, or (at your
+** option) any later version.
+******************************************************************/
+#include "irrklang_backend.h"
+
+using namespace irrklang;
+
+
+IrrKlangBackend::IrrKlangBackend(ISoundEngine *engine)
+    : engine(engine),
+      voices()
+{
+
+}
+
+IrrKlangBackend::~IrrKlangBackend()
+{
+    for (ISound *sound : this->voices)
+        if (sound)
+            sound->drop();
+    this->engine->drop();
+}
+
+GLboolean IrrKlangBackend::Load(SoundHandle sound, const GLchar *file, GLboolean stream)
+{
+    ISoundSource *source = this->engine->addSoundSourceFromFile(file, stream ? ESM_AUTO_DETECT : ESM_NO_STREAMING, !stream);
+    if (this->sources.size() <= sound)
+        this->sources.resize(sound + 1, nullptr);
+    this->sources[sound] = source;
+    return source != nullptr;
+}
+
+GLboolean IrrKlangBackend::Play(GLuint voice, SoundHandle sound, GLboolean loop)
+{
+    if (sound >= this->sources.size() || !this->sources[sound])
+        return GL_FALSE;
+
+    // Tracked, so the voice can tell when the sound ends
+    this->voices[voice] = this->engine->play2D(this->sources[sound], loop != GL_FALSE, false, true);
+    return this->voices[voice] != nullptr;
+}
+
+GLboolean IrrKlangBackend::IsFinished(GLuint voice)
+{
+    return !this->voices[voice] || this->voices[voice]->isFinished();
+}
+
+void IrrKlangBackend::Release(GLuint voice)
+{
+    if (!this->voices[voice])
+        return;
+    this->voices[voice]->stop();
+    this->voices[voice]->drop();
+    this->voices[voice] = nullptr;
+}
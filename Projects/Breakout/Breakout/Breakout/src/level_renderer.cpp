@@ -0,0 +1,154 @@
+/*******************************************************************
+** This code is part of Breakout.
+**
+** Breakout is free software: you can redistribute it and/or modify
+** it under the terms of the CC BY 4.0 license as published by
+** Creative Commons, either version 4 of the License, or (at your
+** option) any later version.
+******************************************************************/
+#include "level_renderer.h"
+#include "gl_state.h"
+
+#include <cstddef>
+#include <iostream>
+
+
+LevelRenderer::LevelRenderer(const Shader &shader, const SpriteRegion &block, const SpriteRegion &solidBlock)
+    : block(block),
+      solidBlock(solidBlock),
+      numVertices(0),
+      level(nullptr),
+      generation(0),
+      resets(0),
+      numDestroyed(0)
+{
+    this->shader = shader;
+
+    // A single Draw() can only sample one texture
+    if (block.Texture.ID != solidBlock.Texture.ID)
+        std::cout << "ERROR::LEVELRENDERER: All bricks must be packed into the same texture" << std::endl;
+
+    this->initRenderData();
+}
+
+LevelRenderer::~LevelRenderer()
+{
+    GLState::DeleteVertexArray(this->VAO);
+    glDeleteBuffers(1, &this->VBO);
+    GLState::DeleteTexture(this->livenessTexture);
+}
+
+void LevelRenderer::Draw(const GameLevel &level, GLuint resets, const std::vector<GLuint> &destroyedCells)
+{
+    if (level.Bricks.empty())
+        return;
+
+    // The liveness texture lives on texture unit 1
+    GLState::ActiveTexture(1);
+    if (this->level != &level || this->generation != level.Generation)
+    {
+        this->bake(level);
+        this->upload(level, destroyedCells);
+    }
+    // A reset brings all bricks back, which only happens when the player loses a life or restarts
+    else if (this->resets != resets || destroyedCells.size() < this->numDestroyed)
+    {
+        this->upload(level, destroyedCells);
+    }
+    // Bricks only change a few times a second, most frames upload nothing
+    else if (destroyedCells.size() > this->numDestroyed)
+    {
+        const GLubyte destroyed = 0;
+        GLState::BindTexture(this->livenessTexture);
+        glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+        for (GLuint i = this->numDestroyed; i < destroyedCells.size(); ++i)
+        {
+            GLuint cell = destroyedCells[i];
+            glTexSubImage2D(GL_TEXTURE_2D, 0, cell % level.GridWidth, cell / level.GridWidth, 1, 1, GL_RED, GL_UNSIGNED_BYTE, &destroyed);
+        }
+    }
+    this->resets = resets;
+    this->numDestroyed = destroyedCells.size();
+
+    // All bricks are packed into the same atlas page, so they are drawn at once
+    this->shader.Use();
+    GLState::BlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+    GLState::ActiveTexture(0);
+    this->block.Texture.Bind();
+    GLState::BindVertexArray(this->VAO);
+    glDrawArrays(GL_TRIANGLES, 0, this->numVertices);
+}
+
+void LevelRenderer::initRenderData()
+{
+    glGenVertexArrays(1, &this->VAO);
+    glGenBuffers(1, &this->VBO);
+    GLState::BindVertexArray(this->VAO);
+    glBindBuffer(GL_ARRAY_BUFFER, this->VBO);
+    glEnableVertexAttribArray(0);
+    glVertexAttribPointer(0, 4, GL_FLOAT, GL_FALSE, sizeof(BrickVertex), (GLvoid*)offsetof(BrickVertex, Position)); // Position and texture coordinates
+    glEnableVertexAttribArray(1);
+    glVertexAttribPointer(1, 3, GL_FLOAT, GL_FALSE, sizeof(BrickVertex), (GLvoid*)offsetof(BrickVertex, Color));
+    glEnableVertexAttribArray(2);
+    glVertexAttribPointer(2, 2, GL_FLOAT, GL_FALSE, sizeof(BrickVertex), (GLvoid*)offsetof(BrickVertex, Cell));
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+    GLState::BindVertexArray(0);
+
+    glGenTextures(1, &this->livenessTexture);
+    GLState::BindTexture(this->livenessTexture);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+}
+
+void LevelRenderer::bake(const GameLevel &level)
+{
+    // Same two triangles as the SpriteRenderer's quad
+    const glm::vec2 corners[6] = {
+        glm::vec2(0.0f, 1.0f), glm::vec2(1.0f, 0.0f), glm::vec2(0.0f, 0.0f),
+        glm::vec2(0.0f, 1.0f), glm::vec2(1.0f, 1.0f), glm::vec2(1.0f, 0.0f)
+    };
+
+    // Bake the quads of all bricks, whether they are alive is left to the liveness texture
+    std::vector<BrickVertex> vertices;
+    vertices.reserve(level.Bricks.size() * 6);
+    for (GLuint i = 0; i < level.Bricks.size(); ++i)
+    {
+        const GameObject &brick = level.Bricks[i];
+        GLuint cell = level.BrickCells[i];
+        glm::vec2 gridPosition(cell % level.GridWidth, cell / level.GridWidth);
+        const glm::vec4 &uv = brick.IsSolid ? this->solidBlock.UV : this->block.UV;
+        for (const glm::vec2 &corner : corners)
+        {
+            BrickVertex vertex = { brick.Position + corner * brick.Size,
+                                   glm::vec2(uv.x, uv.y) + corner * glm::vec2(uv.z, uv.w),
+                                   brick.Color,
+                                   gridPosition };
+            vertices.push_back(vertex);
+        }
+    }
+
+    glBindBuffer(GL_ARRAY_BUFFER, this->VBO);
+    glBufferData(GL_ARRAY_BUFFER, vertices.size() * sizeof(BrickVertex), &vertices[0], GL_STATIC_DRAW);
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+    this->numVertices = vertices.size();
+
+    this->level = &level;
+    this->generation = level.Generation;
+}
+
+void LevelRenderer::upload(const GameLevel &level, const std::vector<GLuint> &destroyedCells)
+{
+    // The cells of all bricks start out alive, the level's geometry never changes after it was loaded
+    this->liveness.assign(level.GridWidth * level.GridHeight, 0);
+    for (GLuint cell : level.BrickCells)
+        this->liveness[cell] = 255;
+    for (GLuint cell : destroyedCells)
+        this->liveness[cell] = 0;
+
+    // 8-bit single channel texture, so disable the byte-alignment restriction
+    GLState::BindTexture(this->livenessTexture);
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+    glTexImage2D(GL_TEXTURE_2D, 0, GL_R8, level.GridWidth, level.GridHeight, 0, GL_RED, GL_UNSIGNED_BYTE, &this->liveness[0]);
+}
@@ -10,13 +10,17 @@
 #include <GLFW/glfw3.h>
 
 #include <iostream>
+#include <string>
 
 #include "game.h"
 #include "resource_manager.h"
+#include "gl_state.h"
+#include "profiler.h"
 
 
 // GLFW function declarations
 void key_callback(GLFWwindow* window, int key, int scancode, int action, int mode);
+void draw_loading_screen(GLuint loaded, GLuint total);
 
 // The Width of the screen
 const GLuint SCREEN_WIDTH = 800;
@@ -46,38 +50,30 @@ int main(int argc, char *argv[])
 
    // OpenGL configuration
    glViewport(0, 0, SCREEN_WIDTH, SCREEN_HEIGHT);
-   glEnable(GL_CULL_FACE);
-   glEnable(GL_BLEND);
-   glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+   GLState::Enable(GL_CULL_FACE);
+   GLState::Enable(GL_BLEND);
+   GLState::BlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
 
-   // Initialize game
-   Breakout.Init();
-
-   // DeltaTime variables
-   GLfloat deltaTime = 0.0f;
-   GLfloat lastFrame = 0.0f;
+   // Initialize game (drawing a progress bar while the textures load)
+   Breakout.Init(draw_loading_screen);
 
    // Start Game within Menu State
-   Breakout.State = GAME_MENU;
+   Breakout.Simulation.State = GAME_MENU;
+
+   // From here on the game is simulated at a fixed rate on its own thread, this one only renders and gathers input
+   // Run with --record <file> to record the input, it can be replayed with BreakoutSim --replay <file>
+   const char *recordFile = argc > 2 && std::string(argv[1]) == "--record" ? argv[2] : nullptr;
+   Breakout.Start(recordFile);
 
    while (!glfwWindowShouldClose(window))
    {
-      // Calculate delta time
-      GLfloat currentFrame = glfwGetTime();
-      deltaTime = currentFrame - lastFrame;
-      lastFrame = currentFrame;
+      Profiler::BeginFrame();
 
       // Process the events that have been received
       // This will cause the window and input callbacks associated with those events to be called
+      // (the simulation picks up the keys on its next tick)
       glfwPollEvents();
 
-      //deltaTime = 0.001f;
-      // Manage user input
-      Breakout.ProcessInput(deltaTime);
-
-      // Update Game state
-      Breakout.Update(deltaTime);
-
       // Render
       glClearColor(0.0f, 0.0f, 0.0f, 1.0f);
       glClear(GL_COLOR_BUFFER_BIT);
@@ -86,6 +82,9 @@ int main(int argc, char *argv[])
       glfwSwapBuffers(window);
    }
 
+   // Stop the simulation before anything it uses goes away
+   Breakout.Stop();
+
    // Delete all resources as loaded using the resource manager
    ResourceManager::Clear();
 
@@ -108,6 +107,20 @@ void key_callback(GLFWwindow* window, int key, int scancode, int action, int mod
    }
 }
 
+void draw_loading_screen(GLuint loaded, GLuint total)
+{
+   // Nothing is loaded that could draw anything yet, so the bar is cleared into a scissor rectangle
+   GLuint barWidth = total > 0 ? SCREEN_WIDTH * loaded / total : SCREEN_WIDTH;
+   glClearColor(0.0f, 0.0f, 0.0f, 1.0f);
+   glClear(GL_COLOR_BUFFER_BIT);
+   glEnable(GL_SCISSOR_TEST);
+   glScissor(0, SCREEN_HEIGHT / 2 - 4, barWidth, 8);
+   glClearColor(1.0f, 1.0f, 1.0f, 1.0f);
+   glClear(GL_COLOR_BUFFER_BIT);
+   glDisable(GL_SCISSOR_TEST);
+   glfwSwapBuffers(glfwGetCurrentContext());
+}
+
 // Additional information:
 // The process of transforming 3D coordinates to 2D pixels is managed by OpenGL's graphics pipeline
 // The graphics pipeline can be divided into two large parts:
@@ -7,10 +7,15 @@
 ** option) any later version.
 ******************************************************************/
 #include "particle_generator.h"
+#include "gl_state.h"
 
-ParticleGenerator::ParticleGenerator(Shader shader, Texture2D texture, GLuint numParticles)
-    : shader(shader), texture(texture), numParticles(numParticles)
+#include <algorithm>
+#include <cstring>
+
+ParticleGenerator::ParticleGenerator(Shader shader, SpriteRegion sprite, GLuint numParticles)
+    : shader(shader), sprite(sprite), numParticles(numParticles), bufferRegion(0), regionFences()
 {
+    this->texRectLocation = this->shader.GetUniformLocation("texRect");
     this->init();
 }
 
@@ -36,96 +41,143 @@ void ParticleGenerator::init()
 
     // Create VAO
     glGenVertexArrays(1, &this->VAO);
-    glBindVertexArray(this->VAO);
+    GLState::BindVertexArray(this->VAO);
 
     // Configure vertex attributes
     glEnableVertexAttribArray(0);
     glVertexAttribPointer(0, 4, GL_FLOAT, GL_FALSE, 4 * sizeof(GLfloat), (GLvoid*)0);
-    glBindVertexArray(0);
 
-    // Create this->numParticles default particle instances
-    for (GLuint i = 0; i < this->numParticles; ++i)
-        this->particles.push_back(Particle());
+    // Create the streaming instance buffer (the attribute pointers are set per region in Draw)
+    glGenBuffers(1, &this->instanceVBO);
+    glBindBuffer(GL_ARRAY_BUFFER, this->instanceVBO);
+    glBufferData(GL_ARRAY_BUFFER, PARTICLE_BUFFER_REGIONS * this->numParticles * (sizeof(glm::vec2) + sizeof(glm::vec4)), NULL, GL_STREAM_DRAW);
+    glEnableVertexAttribArray(1);
+    glEnableVertexAttribArray(2);
+    glVertexAttribDivisor(1, 1);
+    glVertexAttribDivisor(2, 1);
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+    GLState::BindVertexArray(0);
+
+    // Allocate storage for this->numParticles particles, all of which start out dead
+    this->particles.Positions.resize(this->numParticles, glm::vec2(0.0f));
+    this->particles.Velocities.resize(this->numParticles, glm::vec2(0.0f));
+    this->particles.Colors.resize(this->numParticles, glm::vec4(1.0f));
+    this->particles.Life.resize(this->numParticles, 0.0f);
+    this->particles.NumAlive = 0;
 }
 
 void ParticleGenerator::Update(GLfloat dt, GameObject &object, GLuint newParticles, glm::vec2 offsetFromTarget)
 {
-    // Add new particles 
-    for (GLuint i = 0; i < newParticles; ++i)
-    {
-        int unusedParticle = this->firstUnusedParticle();
-        this->respawnParticle(this->particles[unusedParticle], object, offsetFromTarget);
-    }
+    this->Emit(object.Position, object.Velocity, newParticles, offsetFromTarget);
+    this->Update(dt);
+}
 
-    // Update all particles
-    for (GLuint i = 0; i < this->numParticles; ++i)
-    {
-        Particle &p = this->particles[i];
-        p.Life -= dt; // reduce life
-        if (p.Life > 0.0f)
-        {
-            // particle is alive, thus update
-            p.Position -= p.Velocity * dt;
-            p.Color.a -= dt * 2.5;
-        }
-    }
+void ParticleGenerator::Emit(glm::vec2 position, glm::vec2 velocity, GLuint newParticles, glm::vec2 offsetFromTarget)
+{
+    // The first dead particle always sits right after the live range, so spawning is O(1)
+    for (GLuint i = 0; i < newParticles && this->particles.NumAlive < this->numParticles; ++i)
+        this->respawnParticle(this->particles.NumAlive++, position, velocity, offsetFromTarget);
 }
 
-// Render all particles
-void ParticleGenerator::Draw()
+void ParticleGenerator::Update(GLfloat dt)
 {
-    // Use additive blending to give particles a 'glow' effect
-    glBlendFunc(GL_SRC_ALPHA, GL_ONE);
+    ParticlePool &p = this->particles;
 
-    this->shader.Use();
-    for (Particle particle : this->particles)
+    // Reduce the life of all live particles
+    GLfloat *life = p.Life.data();
+    for (GLuint i = 0; i < p.NumAlive; ++i)
+        life[i] -= dt;
+
+    // Kill the particles whose life ran out by moving the last live particle into their slot
+    GLuint i = 0;
+    while (i < p.NumAlive)
     {
-        if (particle.Life > 0.0f)
+        if (life[i] > 0.0f)
         {
-            this->shader.SetVector2f("translation", particle.Position);
-            this->shader.SetVector4f("color", particle.Color);
-            this->texture.Bind();
-            glBindVertexArray(this->VAO);
-            glDrawArrays(GL_TRIANGLES, 0, 6);
-            glBindVertexArray(0);
+            ++i;
+            continue;
         }
+
+        GLuint last = --p.NumAlive;
+        p.Positions[i] = p.Positions[last];
+        p.Velocities[i] = p.Velocities[last];
+        p.Colors[i] = p.Colors[last];
+        life[i] = life[last];
     }
 
-    // Don't forget to reset to default blending mode
-    glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+    // Move and fade the survivors (branch free, so the compiler can vectorize these loops)
+    GLfloat *positions = (GLfloat*)p.Positions.data();
+    const GLfloat *velocities = (const GLfloat*)p.Velocities.data();
+    for (GLuint i = 0; i < p.NumAlive * 2; ++i)
+        positions[i] -= velocities[i] * dt;
+
+    glm::vec4 *colors = p.Colors.data();
+    for (GLuint i = 0; i < p.NumAlive; ++i)
+        colors[i].a -= dt * 2.5f;
 }
 
-// Stores the index of the last particle used (for quick access to next dead particle)
-GLuint lastUsedParticle = 0;
-GLuint ParticleGenerator::firstUnusedParticle()
+const ParticlePool & ParticleGenerator::GetParticles() const
 {
-    // First search from last used particle, this will usually return almost instantly
-    for (GLuint i = lastUsedParticle; i < this->numParticles; ++i){
-        if (this->particles[i].Life <= 0.0f){
-            lastUsedParticle = i;
-            return i;
-        }
-    }
+    return this->particles;
+}
 
-    // Otherwise, do a linear search
-    for (GLuint i = 0; i < lastUsedParticle; ++i){
-        if (this->particles[i].Life <= 0.0f){
-            lastUsedParticle = i;
-            return i;
-        }
+// Render all particles
+void ParticleGenerator::Draw(const glm::vec2 *positions, const glm::vec4 *colors, GLuint count)
+{
+    GLuint numAlive = std::min(count, this->numParticles);
+    if (numAlive == 0)
+        return;
+
+    GLuint region = this->bufferRegion;
+    this->bufferRegion = (this->bufferRegion + 1) % PARTICLE_BUFFER_REGIONS;
+
+    // The last draw that read from this region was issued PARTICLE_BUFFER_REGIONS frames ago, so this should never actually wait
+    if (this->regionFences[region])
+    {
+        while (glClientWaitSync(this->regionFences[region], GL_SYNC_FLUSH_COMMANDS_BIT, 1000000000) == GL_TIMEOUT_EXPIRED) { }
+        glDeleteSync(this->regionFences[region]);
+        this->regionFences[region] = 0;
     }
 
-    // All particles are taken, override the first one (note that if it repeatedly hits this case, more particles should be reserved)
-    lastUsedParticle = 0;
-    return 0;
+    // Copy the live particles into this frame's region of the instance buffer
+    // The positions and colors are already stored contiguously, so each takes a single copy
+    GLintptr positionsOffset = region * this->numParticles * (sizeof(glm::vec2) + sizeof(glm::vec4));
+    GLintptr colorsOffset = positionsOffset + this->numParticles * sizeof(glm::vec2);
+
+    glBindBuffer(GL_ARRAY_BUFFER, this->instanceVBO);
+    GLchar *data = (GLchar*)glMapBufferRange(GL_ARRAY_BUFFER,
+                                             positionsOffset,
+                                             this->numParticles * (sizeof(glm::vec2) + sizeof(glm::vec4)),
+                                             GL_MAP_WRITE_BIT | GL_MAP_INVALIDATE_RANGE_BIT | GL_MAP_UNSYNCHRONIZED_BIT);
+    std::memcpy(data, positions, numAlive * sizeof(glm::vec2));
+    std::memcpy(data + (colorsOffset - positionsOffset), colors, numAlive * sizeof(glm::vec4));
+    glUnmapBuffer(GL_ARRAY_BUFFER);
+
+    // Use additive blending to give particles a 'glow' effect
+    // The other renderers set the blending mode they need themselves, so it isn't reset afterwards
+    GLState::BlendFunc(GL_SRC_ALPHA, GL_ONE);
+
+    this->shader.Use();
+    this->shader.SetVector4f(this->texRectLocation, this->sprite.UV);
+    GLState::ActiveTexture(0);
+    this->sprite.Texture.Bind();
+    GLState::BindVertexArray(this->VAO);
+
+    // Point the per-instance attributes at this frame's region
+    glVertexAttribPointer(1, 2, GL_FLOAT, GL_FALSE, sizeof(glm::vec2), (GLvoid*)positionsOffset);
+    glVertexAttribPointer(2, 4, GL_FLOAT, GL_FALSE, sizeof(glm::vec4), (GLvoid*)colorsOffset);
+    glDrawArraysInstanced(GL_TRIANGLES, 0, 6, numAlive);
+    this->regionFences[region] = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
 }
 
-void ParticleGenerator::respawnParticle(Particle &particle, GameObject &object, glm::vec2 offsetFromTarget)
+void ParticleGenerator::respawnParticle(GLuint index, glm::vec2 position, glm::vec2 velocity, glm::vec2 offsetFromTarget)
 {
-    GLfloat random = ((rand() % 100) - 50) / 10.0f;
-    GLfloat rColor = 0.5 + ((rand() % 100) / 100.0f);
-    particle.Position = object.Position + random + offsetFromTarget;
-    particle.Color = glm::vec4(rColor, rColor, rColor, 1.0f);
-    particle.Life = 1.0f;
-    particle.Velocity = object.Velocity * 0.1f;
+    GLfloat random = (this->rng.Below(100) - 50.0f) / 10.0f;
+    GLfloat rColor = 0.5 + (this->rng.Below(100) / 100.0f);
+    this->particles.Positions[index] = position + random + offsetFromTarget;
+    this->particles.Colors[index] = glm::vec4(rColor, rColor, rColor, 1.0f);
+    this->particles.Life[index] = 1.0f;
+    this->particles.Velocities[index] = velocity * 0.1f;
 }
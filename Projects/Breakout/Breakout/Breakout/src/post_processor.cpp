@@ -7,38 +7,71 @@
 ** option) any later version.
 ******************************************************************/
 #include "post_processor.h"
+#include "gl_state.h"
 
 #include <iostream>
 
-PostProcessor::PostProcessor(Shader shader, GLuint width, GLuint height)
+PostPass::PostPass(Shader shader, GLfloat scale, glm::vec2 step)
+    : PassShader(shader),
+      Scale(scale),
+      Step(step),
+      Enabled(GL_TRUE),
+      Version(0),
+      target(-1),
+      inputTarget(-1),
+      inputVersion(0),
+      version(0),
+      targetVersion(0),
+      stepLocation(-1)
+{
+
+}
+
+PostProcessor::PostProcessor(Shader shader, GLuint width, GLuint height, GLuint samples, GLfloat renderScale)
     : PostProcessingShader(shader),
       Texture(),
       Width(width),
       Height(height),
+      RenderWidth(glm::max(static_cast<GLuint>(width * renderScale), 1u)),
+      RenderHeight(glm::max(static_cast<GLuint>(height * renderScale), 1u)),
+      Samples(samples),
       Confuse(GL_FALSE),
       Chaos(GL_FALSE),
-      Shake(GL_FALSE)
+      Shake(GL_FALSE),
+      MSFBO(0),
+      RBO(0),
+      rendering(GL_FALSE),
+      sceneVersion(0),
+      output(-1)
 {
-    // Initialize renderbuffer/framebuffer object
-    glGenFramebuffers(1, &this->MSFBO);
-    glGenFramebuffers(1, &this->FBO);
-    glGenRenderbuffers(1, &this->RBO);
-    
-    // Initialize renderbuffer storage with a multisampled color buffer (don't need a depth/stencil buffer)
-    glBindFramebuffer(GL_FRAMEBUFFER, this->MSFBO);
-    glBindRenderbuffer(GL_RENDERBUFFER, this->RBO);
-    // Allocate storage for render buffer object
-    glRenderbufferStorageMultisample(GL_RENDERBUFFER, 8, GL_RGB, width, height);
-    // Attach MS render buffer object to framebuffer
-    glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_RENDERBUFFER, this->RBO);
-    if (glCheckFramebufferStatus(GL_FRAMEBUFFER) != GL_FRAMEBUFFER_COMPLETE)
+    if (this->Samples > 0)
     {
-        std::cout << "ERROR::POSTPROCESSOR: Failed to initialize MSFBO" << std::endl;
+        // The driver may not support as many samples as requested
+        GLint maxSamples;
+        glGetIntegerv(GL_MAX_SAMPLES, &maxSamples);
+        this->Samples = glm::min(this->Samples, static_cast<GLuint>(maxSamples));
+
+        // Initialize renderbuffer/framebuffer object
+        glGenFramebuffers(1, &this->MSFBO);
+        glGenRenderbuffers(1, &this->RBO);
+
+        // Initialize renderbuffer storage with a multisampled color buffer (don't need a depth/stencil buffer)
+        glBindFramebuffer(GL_FRAMEBUFFER, this->MSFBO);
+        glBindRenderbuffer(GL_RENDERBUFFER, this->RBO);
+        // Allocate storage for render buffer object
+        glRenderbufferStorageMultisample(GL_RENDERBUFFER, this->Samples, GL_RGB8, this->RenderWidth, this->RenderHeight);
+        // Attach MS render buffer object to framebuffer
+        glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_RENDERBUFFER, this->RBO);
+        if (glCheckFramebufferStatus(GL_FRAMEBUFFER) != GL_FRAMEBUFFER_COMPLETE)
+        {
+            std::cout << "ERROR::POSTPROCESSOR: Failed to initialize MSFBO" << std::endl;
+        }
     }
 
     // Also initialize the FBO/texture to blit multisampled color-buffer to; used for shader operations (for postprocessing effects)
+    glGenFramebuffers(1, &this->FBO);
     glBindFramebuffer(GL_FRAMEBUFFER, this->FBO);
-    this->Texture.Generate(width, height, NULL);
+    this->Texture.Generate(this->RenderWidth, this->RenderHeight, NULL);
     // Attach texture to framebuffer as its color attachment
     glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, this->Texture.ID, 0);
     if (glCheckFramebufferStatus(GL_FRAMEBUFFER) != GL_FRAMEBUFFER_COMPLETE)
@@ -51,73 +84,171 @@ PostProcessor::PostProcessor(Shader shader, GLuint width, GLuint height)
     this->initRenderData();
 
     this->PostProcessingShader.SetInteger("scene", 0, GL_TRUE);
+}
 
-    GLfloat offset = 1.0f / 300.0f;
-    GLfloat offsets[9][2] = {
-        { -offset,  offset  },  // top-left
-        {  0.0f,    offset  },  // top-center
-        {  offset,  offset  },  // top-right
-        { -offset,  0.0f    },  // center-left
-        {  0.0f,    0.0f    },  // center-center
-        {  offset,  0.0f    },  // center - right
-        { -offset, -offset  },  // bottom-left
-        {  0.0f,   -offset  },  // bottom-center
-        {  offset, -offset  }   // bottom-right
-    };
-    glUniform2fv(glGetUniformLocation(this->PostProcessingShader.ID, "offsets"), 9, (GLfloat*)offsets);
+PostProcessor::~PostProcessor()
+{
+    glDeleteFramebuffers(1, &this->FBO);
+    if (this->MSFBO)
+    {
+        glDeleteFramebuffers(1, &this->MSFBO);
+        glDeleteRenderbuffers(1, &this->RBO);
+    }
+    GLState::DeleteTexture(this->Texture.ID);
+    for (PostTarget &target : this->targets)
+    {
+        glDeleteFramebuffers(1, &target.FBO);
+        GLState::DeleteTexture(target.Texture.ID);
+    }
+    GLState::DeleteVertexArray(this->VAO);
+    glDeleteBuffers(1, &this->VBO);
+}
 
-    GLint edge_kernel[9] = {
-        -1, -1, -1,
-        -1,  8, -1,
-        -1, -1, -1
-    };
-    glUniform1iv(glGetUniformLocation(this->PostProcessingShader.ID, "edge_kernel"), 9, edge_kernel);
+GLuint PostProcessor::AddPass(Shader shader, GLfloat scale, glm::vec2 step)
+{
+    shader.SetInteger("scene", 0, GL_TRUE);
+    this->Passes.push_back(PostPass(shader, scale, step));
+    this->Passes.back().stepLocation = shader.GetUniformLocation("step");
+    return this->Passes.size() - 1;
+}
 
-    GLfloat blur_kernel[9] = {
-        1.0 / 16, 2.0 / 16, 1.0 / 16,
-        2.0 / 16, 4.0 / 16, 2.0 / 16,
-        1.0 / 16, 2.0 / 16, 1.0 / 16
-    };
-    glUniform1fv(glGetUniformLocation(this->PostProcessingShader.ID, "blur_kernel"), 9, blur_kernel);
+GLboolean PostProcessor::IsActive() const
+{
+    if (this->Confuse || this->Chaos || this->Shake)
+        return GL_TRUE;
+    for (const PostPass &pass : this->Passes)
+        if (pass.Enabled)
+            return GL_TRUE;
+    return GL_FALSE;
 }
 
 void PostProcessor::BeginRender()
 {
-    glBindFramebuffer(GL_FRAMEBUFFER, this->MSFBO);
+    // Nothing to apply, so the game goes straight to the screen
+    this->rendering = this->IsActive();
+    if (!this->rendering)
+        return;
+
+    glBindFramebuffer(GL_FRAMEBUFFER, this->Samples > 0 ? this->MSFBO : this->FBO);
+    glViewport(0, 0, this->RenderWidth, this->RenderHeight);
     glClearColor(0.0f, 0.0f, 0.0f, 1.0f);
     glClear(GL_COLOR_BUFFER_BIT);
 }
 
 void PostProcessor::EndRender()
 {
+    if (!this->rendering)
+        return;
+
     // Now resolve multisampled color-buffer into intermediate FBO to store to texture
-    glBindFramebuffer(GL_READ_FRAMEBUFFER, this->MSFBO);
-    glBindFramebuffer(GL_DRAW_FRAMEBUFFER, this->FBO);
-    glBlitFramebuffer(0, 0, this->Width, this->Height, 0, 0, this->Width, this->Height, GL_COLOR_BUFFER_BIT, GL_NEAREST);
+    if (this->Samples > 0)
+    {
+        glBindFramebuffer(GL_READ_FRAMEBUFFER, this->MSFBO);
+        glBindFramebuffer(GL_DRAW_FRAMEBUFFER, this->FBO);
+        glBlitFramebuffer(0, 0, this->RenderWidth, this->RenderHeight, 0, 0, this->RenderWidth, this->RenderHeight, GL_COLOR_BUFFER_BIT, GL_NEAREST);
+    }
+    ++this->sceneVersion;
+
+    // Run the effect graph on the rendered game
+    this->runPasses();
     glBindFramebuffer(GL_FRAMEBUFFER, 0); // Binds both READ and WRITE framebuffer to default framebuffer
+    glViewport(0, 0, this->Width, this->Height);
 }
 
-void PostProcessor::Render(GLfloat time)
+void PostProcessor::Render()
 {
-    // Set uniforms/options
+    if (!this->rendering)
+        return;
+
+    // The options and the time reach the shader through the FrameConstants block
     this->PostProcessingShader.Use();
-    this->PostProcessingShader.SetFloat("time", time);
-    this->PostProcessingShader.SetInteger("confuse", this->Confuse);
-    this->PostProcessingShader.SetInteger("chaos", this->Chaos);
-    this->PostProcessingShader.SetInteger("shake", this->Shake);
-
-    // Render textured quad
-    glActiveTexture(GL_TEXTURE0);
-    this->Texture.Bind();
-    glBindVertexArray(this->VAO);
+
+    // Render textured quad (scaled up to the screen if the game was rendered at a lower resolution)
+    GLState::BlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+    GLState::ActiveTexture(0);
+    if (this->output >= 0)
+        this->targets[this->output].Texture.Bind();
+    else
+        this->Texture.Bind();
+    GLState::BindVertexArray(this->VAO);
     glDrawArrays(GL_TRIANGLES, 0, 6);
-    glBindVertexArray(0);
+}
+
+void PostProcessor::runPasses()
+{
+    // The passes replace the whole target, so there's nothing to blend with
+    GLState::Disable(GL_BLEND);
+    GLState::ActiveTexture(0);
+    GLState::BindVertexArray(this->VAO);
+
+    GLint input = -1;
+    GLuint inputWidth = this->RenderWidth, inputHeight = this->RenderHeight;
+    for (PostPass &pass : this->Passes)
+    {
+        if (!pass.Enabled)
+            continue;
+
+        GLuint width = glm::max(static_cast<GLuint>(this->RenderWidth * pass.Scale), 1u);
+        GLuint height = glm::max(static_cast<GLuint>(this->RenderHeight * pass.Scale), 1u);
+        GLint target = this->acquireTarget(width, height, input);
+        GLuint inputVersion = input >= 0 ? this->targets[input].Version : this->sceneVersion;
+
+        // Skip the pass if its output is still in its target and nothing it depends on changed since
+        if (pass.target != target || pass.targetVersion != this->targets[target].Version ||
+            pass.inputTarget != input || pass.inputVersion != inputVersion || pass.version != pass.Version)
+        {
+            PostTarget &output = this->targets[target];
+            glBindFramebuffer(GL_FRAMEBUFFER, output.FBO);
+            glViewport(0, 0, width, height);
+            pass.PassShader.Use();
+            pass.PassShader.SetVector2f(pass.stepLocation, pass.Step / glm::vec2(inputWidth, inputHeight));
+            if (input >= 0)
+                this->targets[input].Texture.Bind();
+            else
+                this->Texture.Bind();
+            glDrawArrays(GL_TRIANGLES, 0, 6);
+
+            ++output.Version;
+            pass.target = target;
+            pass.targetVersion = output.Version;
+            pass.inputTarget = input;
+            pass.inputVersion = inputVersion;
+            pass.version = pass.Version;
+        }
+
+        input = target;
+        inputWidth = width;
+        inputHeight = height;
+    }
+    this->output = input;
+    GLState::Enable(GL_BLEND);
+}
+
+GLint PostProcessor::acquireTarget(GLuint width, GLuint height, GLint input)
+{
+    // Targets are handed out in a fixed order, so a pass gets the same target every frame as long as the enabled passes don't change
+    for (GLuint i = 0; i < this->targets.size(); ++i)
+        if (static_cast<GLint>(i) != input && this->targets[i].Texture.Width == width && this->targets[i].Texture.Height == height)
+            return i;
+
+    // None of that size is free yet
+    PostTarget target;
+    target.Version = 0;
+    glGenFramebuffers(1, &target.FBO);
+    glBindFramebuffer(GL_FRAMEBUFFER, target.FBO);
+    target.Texture.Generate(width, height, NULL);
+    glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, target.Texture.ID, 0);
+    if (glCheckFramebufferStatus(GL_FRAMEBUFFER) != GL_FRAMEBUFFER_COMPLETE)
+    {
+        std::cout << "ERROR::POSTPROCESSOR: Failed to initialize the target of a pass" << std::endl;
+    }
+    this->targets.push_back(target);
+    return this->targets.size() - 1;
 }
 
 void PostProcessor::initRenderData()
 {
     // Configure VAO/VBO
-    GLuint VBO;
     GLfloat vertices[] = {
         // Pos        // Tex
         -1.0f, -1.0f, 0.0f, 0.0f,
@@ -129,14 +260,14 @@ void PostProcessor::initRenderData()
          1.0f,  1.0f, 1.0f, 1.0f
     };
     glGenVertexArrays(1, &this->VAO);
-    glGenBuffers(1, &VBO);
+    glGenBuffers(1, &this->VBO);
 
-    glBindBuffer(GL_ARRAY_BUFFER, VBO);
+    glBindBuffer(GL_ARRAY_BUFFER, this->VBO);
     glBufferData(GL_ARRAY_BUFFER, sizeof(vertices), vertices, GL_STATIC_DRAW);
 
-    glBindVertexArray(this->VAO);
+    GLState::BindVertexArray(this->VAO);
     glEnableVertexAttribArray(0);
     glVertexAttribPointer(0, 4, GL_FLOAT, GL_FALSE, 4 * sizeof(GL_FLOAT), (GLvoid*)0);
     glBindBuffer(GL_ARRAY_BUFFER, 0);
-    glBindVertexArray(0);
+    GLState::BindVertexArray(0);
 }
@@ -0,0 +1,72 @@
+/*******************************************************************
+** This code is part of Breakout.
+**
+** Breakout is free software: you can redistribute it and/or modify
+** it under the terms of the CC BY 4.0 license as published by
+** Creative Commons, either version 4 of the License, or (at your
+** option) any later version.
+******************************************************************/
+#include "power_up.h"
+
+#include <fstream>
+#include <iostream>
+#include <sstream>
+
+
+// Names of the PowerUp types, indexed by PowerUpType
+const GLchar *POWERUP_NAMES[NUM_POWERUP_TYPES] = {
+    "speed",
+    "sticky",
+    "pass-through",
+    "pad-size-increase",
+    "split",
+    "confuse",
+    "chaos"
+};
+
+const GLchar * PowerUpName(PowerUpType type)
+{
+    return POWERUP_NAMES[type];
+}
+
+std::vector<PowerUpDefinition> LoadPowerUpDefinitions(const GLchar *file)
+{
+    std::vector<PowerUpDefinition> definitions(NUM_POWERUP_TYPES);
+    for (GLuint type = 0; type < NUM_POWERUP_TYPES; ++type)
+        definitions[type].Name = POWERUP_NAMES[type];
+
+    std::ifstream fstream(file);
+    if (!fstream)
+    {
+        std::cout << "ERROR::POWERUP: Failed to read PowerUp definitions: " << file << std::endl;
+        return definitions;
+    }
+
+    std::string line;
+    while (std::getline(fstream, line))
+    {
+        // Skip empty lines and comments
+        std::istringstream sstream(line);
+        std::string name;
+        if (!(sstream >> name) || name[0] == '#')
+            continue;
+
+        GLuint type = 0;
+        while (type < NUM_POWERUP_TYPES && name != POWERUP_NAMES[type])
+            ++type;
+        if (type == NUM_POWERUP_TYPES)
+        {
+            std::cout << "ERROR::POWERUP: Unknown PowerUp type: " << name << std::endl;
+            continue;
+        }
+
+        PowerUpDefinition &definition = definitions[type];
+        if (!(sstream >> definition.Chance >> definition.Duration >> definition.Color.r >> definition.Color.g >> definition.Color.b >> definition.Sprite))
+        {
+            std::cout << "ERROR::POWERUP: Malformed definition of PowerUp type: " << name << std::endl;
+            definitions[type] = PowerUpDefinition();
+            definitions[type].Name = name;
+        }
+    }
+    return definitions;
+}
@@ -0,0 +1,141 @@
+/*******************************************************************
+** This code is part of Breakout.
+**
+** Breakout is free software: you can redistribute it and/or modify
+** it under the terms of the CC BY 4.0 license as published by
+** Creative Commons, either version 4 of the License, or (at your
+** option) any later version.
+******************************************************************/
+#include "profiler.h"
+
+#include <algorithm>
+#include <fstream>
+#include <iostream>
+
+
+// Names of the zones, indexed by ProfileZone
+const GLchar *ZONE_NAMES[NUM_PROFILE_ZONES] = {
+    "process_input",
+    "update",
+    "collisions",
+    "render",
+    "gpu_render"
+};
+
+// Instantiate static variables
+GLboolean Profiler::Enabled = GL_TRUE;
+std::atomic<GLdouble> Profiler::times[PROFILE_HISTORY][NUM_PROFILE_ZONES];
+std::atomic<GLuint64> Profiler::frame(0);
+GLboolean Profiler::open[NUM_PROFILE_ZONES];
+std::chrono::steady_clock::time_point Profiler::started[NUM_PROFILE_ZONES];
+
+
+void Profiler::BeginFrame()
+{
+    // The frame's row is cleared before it becomes current, so other threads never record into a row that is being cleared
+    GLuint64 next = frame + 1;
+    std::fill(times[next % PROFILE_HISTORY], times[next % PROFILE_HISTORY] + NUM_PROFILE_ZONES, -1.0);
+    frame = next;
+}
+
+void Profiler::Begin(ProfileZone zone)
+{
+    open[zone] = GL_TRUE;
+    started[zone] = std::chrono::steady_clock::now();
+}
+
+void Profiler::End(ProfileZone zone)
+{
+    if (!open[zone])
+        return;
+    open[zone] = GL_FALSE;
+    std::chrono::duration<GLdouble, std::milli> elapsed = std::chrono::steady_clock::now() - started[zone];
+    Record(zone, frame, elapsed.count());
+}
+
+void Profiler::Record(ProfileZone zone, GLuint64 frame, GLdouble milliseconds)
+{
+    GLuint64 current = Profiler::frame;
+    if (frame > current || current - frame >= PROFILE_HISTORY || frame == 0)
+        return;
+    // Another thread may be adding to the same zone of the frame, so the sum is only stored if nothing changed in between
+    std::atomic<GLdouble> &time = times[frame % PROFILE_HISTORY][zone];
+    GLdouble old = time.load(std::memory_order_relaxed);
+    while (!time.compare_exchange_weak(old, std::max(old, 0.0) + milliseconds, std::memory_order_relaxed))
+        ;
+}
+
+GLuint64 Profiler::Frame()
+{
+    return frame;
+}
+
+ProfileStats Profiler::Stats(ProfileZone zone)
+{
+    // Collect the frames the zone was timed in
+    static GLdouble samples[PROFILE_HISTORY];
+    GLuint count = 0;
+    GLdouble sum = 0.0;
+    GLuint64 current = frame;
+    GLuint64 kept = std::min<GLuint64>(current, PROFILE_HISTORY);
+    for (GLuint64 f = current - kept + 1; f < current; ++f)
+    {
+        GLdouble time = times[f % PROFILE_HISTORY][zone];
+        if (time < 0.0)
+            continue;
+        samples[count++] = time;
+        sum += time;
+    }
+
+    ProfileStats stats = { 0.0, 0.0, 0.0, count };
+    if (count == 0)
+        return stats;
+    GLuint p99 = (count * 99 + 99) / 100 - 1; // Index of the 99th percentile in the sorted samples
+    std::nth_element(samples, samples + p99, samples + count);
+    stats.P99 = samples[p99];
+    stats.Min = *std::min_element(samples, samples + count);
+    stats.Average = sum / count;
+    return stats;
+}
+
+GLboolean Profiler::WriteCSV(const GLchar *file)
+{
+    std::ofstream csv(file);
+    csv << "frame";
+    for (GLuint zone = 0; zone < NUM_PROFILE_ZONES; ++zone)
+        csv << "," << ZONE_NAMES[zone];
+    csv << "\n";
+
+    GLuint64 current = frame;
+    GLuint64 kept = std::min<GLuint64>(current, PROFILE_HISTORY);
+    for (GLuint64 f = current - kept + 1; f < current; ++f)
+    {
+        csv << f;
+        for (GLuint zone = 0; zone < NUM_PROFILE_ZONES; ++zone)
+        {
+            csv << ",";
+            GLdouble time = times[f % PROFILE_HISTORY][zone];
+            if (time >= 0.0) // Zones that weren't timed in the frame are left empty
+                csv << time;
+        }
+        csv << "\n";
+    }
+
+    if (!csv)
+    {
+        std::cout << "ERROR::PROFILER: Failed to write profile: " << file << std::endl;
+        return GL_FALSE;
+    }
+    return GL_TRUE;
+}
+
+const GLchar * Profiler::ZoneName(ProfileZone zone)
+{
+    return ZONE_NAMES[zone];
+}
+
+void Profiler::Clear()
+{
+    frame = 0;
+    std::fill(open, open + NUM_PROFILE_ZONES, GL_FALSE);
+}
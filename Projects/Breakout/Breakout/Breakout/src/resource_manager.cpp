@@ -7,7 +7,9 @@
 ** option) any later version.
 ******************************************************************/
 #include "resource_manager.h"
+#include "gl_state.h"
 
+#include <algorithm>
 #include <iostream>
 #include <sstream>
 #include <fstream>
@@ -15,40 +17,274 @@
 #include <stb_image.h>
 
 // Instantiate static variables
-std::map<std::string, Texture2D>    ResourceManager::Textures;
-std::map<std::string, Shader>       ResourceManager::Shaders;
+std::vector<Texture2D>              ResourceManager::Textures;
+std::vector<Shader>                 ResourceManager::Shaders;
+std::vector<SpriteRegion>           ResourceManager::Sprites;
+std::vector<Texture2D>              ResourceManager::AtlasPages;
+std::vector<ResourceManager::AtlasImage> ResourceManager::pendingAtlasImages;
+ThreadPool *                        ResourceManager::decoders = nullptr;
+std::mutex                          ResourceManager::decodedMutex;
+std::condition_variable             ResourceManager::decodedReady;
+std::vector<std::shared_ptr<ResourceManager::DecodeJob>> ResourceManager::decodedJobs;
+GLuint                              ResourceManager::loadsQueued = 0;
+GLuint                              ResourceManager::loadsFinished = 0;
+std::map<std::string, ShaderHandle>  ResourceManager::shaderIDs;
+std::map<std::string, TextureHandle> ResourceManager::textureIDs;
+std::map<std::string, SpriteHandle>  ResourceManager::spriteIDs;
 
+// Number of pixels each atlas sprite's border is extruded by, so linear filtering never samples its neighbours
+const GLint ATLAS_PADDING = 1;
 
-Shader ResourceManager::LoadShader(const GLchar *vShaderFile, const GLchar *fShaderFile, const GLchar *gShaderFile, std::string name)
+
+ShaderHandle ResourceManager::ShaderID(const std::string &name)
+{
+   return intern(shaderIDs, Shaders, name);
+}
+
+TextureHandle ResourceManager::TextureID(const std::string &name)
+{
+   return intern(textureIDs, Textures, name);
+}
+
+SpriteHandle ResourceManager::SpriteID(const std::string &name)
+{
+   return intern(spriteIDs, Sprites, name);
+}
+
+Shader ResourceManager::LoadShader(const GLchar *vShaderFile, const GLchar *fShaderFile, const GLchar *gShaderFile, const std::string &name)
+{
+   ShaderHandle handle = ShaderID(name);
+   Shaders[handle] = loadShaderFromFile(vShaderFile, fShaderFile, gShaderFile);
+   return Shaders[handle];
+}
+
+Shader & ResourceManager::GetShader(ShaderHandle handle)
+{
+   return Shaders[handle];
+}
+
+const Shader & ResourceManager::GetShader(const std::string &name)
+{
+   static const Shader missing;
+   GLint handle = find(shaderIDs, name, "shader");
+   return handle >= 0 ? Shaders[handle] : missing;
+}
+
+Texture2D ResourceManager::LoadTexture(const GLchar *file, GLboolean alpha, const std::string &name)
+{
+   TextureHandle handle = TextureID(name);
+   Textures[handle] = loadTextureFromFile(file, alpha);
+   return Textures[handle];
+}
+
+std::shared_future<Texture2D> ResourceManager::LoadTextureAsync(const GLchar *file, GLboolean alpha, const std::string &name)
+{
+   std::shared_ptr<DecodeJob> job = std::make_shared<DecodeJob>();
+   job->File = file;
+   job->Name = name;
+   job->Handle = TextureID(name);
+   job->Alpha = alpha;
+   job->Atlas = GL_FALSE;
+   std::shared_future<Texture2D> texture = job->Texture.get_future().share();
+   decodeAsync(job);
+   return texture;
+}
+
+const Texture2D & ResourceManager::GetTexture(TextureHandle handle)
+{
+   return Textures[handle];
+}
+
+const Texture2D & ResourceManager::GetTexture(const std::string &name)
+{
+   static const Texture2D missing;
+   GLint handle = find(textureIDs, name, "texture");
+   return handle >= 0 ? Textures[handle] : missing;
+}
+
+void ResourceManager::AddAtlasSprite(const GLchar *file, const std::string &name)
+{
+   std::shared_ptr<DecodeJob> job = std::make_shared<DecodeJob>();
+   job->File = file;
+   job->Name = name;
+   job->Handle = SpriteID(name);
+   job->Alpha = GL_TRUE;
+   job->Atlas = GL_TRUE;
+   decodeAsync(job);
+}
+
+void ResourceManager::BuildAtlas(GLuint pageSize)
+{
+   // All images have to be there before they can be packed
+   FinishLoading();
+
+   // Pack the tallest images first, which keeps the skyline flat and the pages dense
+   // (ties are broken by name, so the layout doesn't depend on the order in which the images finished decoding)
+   std::sort(pendingAtlasImages.begin(), pendingAtlasImages.end(),
+      [](const AtlasImage &a, const AtlasImage &b) { return a.Height != b.Height ? a.Height > b.Height : a.Name < b.Name; });
+
+   std::vector<SkylinePacker> packers;
+   std::vector<GLint>         pages(pendingAtlasImages.size(), -1);
+   std::vector<glm::uvec2>    positions(pendingAtlasImages.size());
+   for (GLuint i = 0; i < pendingAtlasImages.size(); ++i)
+   {
+      const AtlasImage &image = pendingAtlasImages[i];
+      GLuint width = image.Width + 2 * ATLAS_PADDING;
+      GLuint height = image.Height + 2 * ATLAS_PADDING;
+      if (width > pageSize || height > pageSize)
+      {
+         std::cout << "ERROR::ATLAS: " << image.Name << " does not fit on an atlas page" << std::endl;
+         continue;
+      }
+
+      // Try the existing pages first and only open a new one if none has room left
+      for (GLuint page = 0; page < packers.size() && pages[i] < 0; ++page)
+         if (packers[page].Pack(width, height, positions[i]))
+            pages[i] = page;
+      if (pages[i] < 0)
+      {
+         packers.push_back(SkylinePacker(pageSize, pageSize));
+         packers.back().Pack(width, height, positions[i]);
+         pages[i] = packers.size() - 1;
+      }
+   }
+
+   // Copy the images into their pages (extruding their borders into the padding) and upload each page once
+   GLuint firstPage = AtlasPages.size();
+   std::vector<unsigned char> pixels(pageSize * pageSize * 4);
+   for (GLuint page = 0; page < packers.size(); ++page)
+   {
+      std::fill(pixels.begin(), pixels.end(), 0);
+      for (GLuint i = 0; i < pendingAtlasImages.size(); ++i)
+      {
+         if (pages[i] != static_cast<GLint>(page))
+            continue;
+
+         const AtlasImage &image = pendingAtlasImages[i];
+         for (GLint y = -ATLAS_PADDING; y < image.Height + ATLAS_PADDING; ++y)
+         {
+            GLint srcY = glm::clamp(y, 0, image.Height - 1);
+            for (GLint x = -ATLAS_PADDING; x < image.Width + ATLAS_PADDING; ++x)
+            {
+               GLint srcX = glm::clamp(x, 0, image.Width - 1);
+               GLuint dst = ((positions[i].y + ATLAS_PADDING + y) * pageSize + positions[i].x + ATLAS_PADDING + x) * 4;
+               std::copy(image.Pixels + (srcY * image.Width + srcX) * 4, image.Pixels + (srcY * image.Width + srcX) * 4 + 4, &pixels[dst]);
+            }
+         }
+      }
+
+      Texture2D texture;
+      texture.Internal_Format = GL_RGBA;
+      texture.Image_Format = GL_RGBA;
+      texture.Wrap_S = GL_CLAMP_TO_EDGE;
+      texture.Wrap_T = GL_CLAMP_TO_EDGE;
+      texture.Generate(pageSize, pageSize, &pixels[0]);
+      AtlasPages.push_back(texture);
+   }
+
+   // Register the sprites and release the decoded images
+   for (GLuint i = 0; i < pendingAtlasImages.size(); ++i)
+   {
+      const AtlasImage &image = pendingAtlasImages[i];
+      if (pages[i] >= 0)
+      {
+         glm::vec4 uv(static_cast<GLfloat>(positions[i].x + ATLAS_PADDING) / pageSize,
+                      static_cast<GLfloat>(positions[i].y + ATLAS_PADDING) / pageSize,
+                      static_cast<GLfloat>(image.Width) / pageSize,
+                      static_cast<GLfloat>(image.Height) / pageSize);
+         Sprites[image.Sprite] = SpriteRegion(AtlasPages[firstPage + pages[i]], uv);
+      }
+      stbi_image_free(image.Pixels);
+   }
+   pendingAtlasImages.clear();
+}
+
+const SpriteRegion & ResourceManager::GetSprite(SpriteHandle handle)
+{
+   return Sprites[handle];
+}
+
+const SpriteRegion & ResourceManager::GetSprite(const std::string &name)
 {
-   Shaders[name] = loadShaderFromFile(vShaderFile, fShaderFile, gShaderFile);
-   return Shaders[name];
+   static const SpriteRegion missing;
+   GLint handle = find(spriteIDs, name, "sprite");
+   return handle >= 0 ? Sprites[handle] : missing;
 }
 
-Shader ResourceManager::GetShader(std::string name)
+GLboolean ResourceManager::UpdateLoading()
 {
-   return Shaders[name];
+   std::vector<std::shared_ptr<DecodeJob>> jobs;
+   {
+      std::lock_guard<std::mutex> lock(decodedMutex);
+      jobs.swap(decodedJobs);
+   }
+   for (std::shared_ptr<DecodeJob> &job : jobs)
+   {
+      finishDecode(*job);
+      ++loadsFinished;
+   }
+   return loadsFinished == loadsQueued;
 }
 
-Texture2D ResourceManager::LoadTexture(const GLchar *file, GLboolean alpha, std::string name)
+void ResourceManager::FinishLoading(LoadProgressCallback progress)
 {
-   Textures[name] = loadTextureFromFile(file, alpha);
-   return Textures[name];
+   while (!UpdateLoading())
+   {
+      if (progress)
+         progress(loadsFinished, loadsQueued);
+
+      // Sleep until the next image is decoded
+      std::unique_lock<std::mutex> lock(decodedMutex);
+      decodedReady.wait(lock, [] { return !decodedJobs.empty(); });
+   }
+   if (progress)
+      progress(loadsFinished, loadsQueued);
 }
 
-Texture2D ResourceManager::GetTexture(std::string name)
+GLuint ResourceManager::CheckLoaded()
 {
-   return Textures[name];
+   // Resources hold no GL object until they are loaded
+   GLuint missing = 0;
+   for (const auto &entry : shaderIDs)
+      if (Shaders[entry.second].ID == 0)
+      {
+         std::cout << "ERROR::RESOURCEMANAGER: No shader was loaded as " << entry.first << std::endl;
+         ++missing;
+      }
+   for (const auto &entry : textureIDs)
+      if (Textures[entry.second].ID == 0)
+      {
+         std::cout << "ERROR::RESOURCEMANAGER: No texture was loaded as " << entry.first << std::endl;
+         ++missing;
+      }
+   for (const auto &entry : spriteIDs)
+      if (Sprites[entry.second].Texture.ID == 0)
+      {
+         std::cout << "ERROR::RESOURCEMANAGER: No sprite was loaded as " << entry.first << std::endl;
+         ++missing;
+      }
+   return missing;
 }
 
 void ResourceManager::Clear()
 {
+   // Stop the decoders (they finish what is queued first) and drop the images that were never uploaded
+   delete decoders;
+   decoders = nullptr;
+   for (std::shared_ptr<DecodeJob> &job : decodedJobs)
+      stbi_image_free(job->Pixels);
+   decodedJobs.clear();
+   loadsQueued = loadsFinished = 0;
+
    // (Properly) delete all shaders
-   for (auto iter : Shaders)
-      glDeleteProgram(iter.second.ID);
+   for (Shader &shader : Shaders)
+      GLState::DeleteProgram(shader.ID);
    // (Properly) delete all textures
-   for (auto iter : Textures)
-      glDeleteTextures(1, &iter.second.ID);
+   for (Texture2D &texture : Textures)
+      GLState::DeleteTexture(texture.ID);
+   // (Properly) delete all atlas pages
+   for (Texture2D &page : AtlasPages)
+      GLState::DeleteTexture(page.ID);
 }
 
 Shader ResourceManager::loadShaderFromFile(const GLchar *vShaderFile, const GLchar *fShaderFile, const GLchar *gShaderFile)
@@ -103,6 +339,81 @@ Shader ResourceManager::loadShaderFromFile(const GLchar *vShaderFile, const GLch
    return shader;
 }
 
+void ResourceManager::decodeAsync(std::shared_ptr<DecodeJob> job)
+{
+   if (!decoders)
+      decoders = new ThreadPool();
+   ++loadsQueued;
+   decoders->Submit([job]()
+   {
+      // Atlas images are always expanded to 4 channels, textures keep the channels of the file
+      int nrChannels;
+      job->Pixels = stbi_load(job->File.c_str(), &job->Width, &job->Height, &nrChannels, job->Atlas ? 4 : 0);
+      {
+         std::lock_guard<std::mutex> lock(decodedMutex);
+         decodedJobs.push_back(job);
+      }
+      decodedReady.notify_one();
+   });
+}
+
+void ResourceManager::finishDecode(DecodeJob &job)
+{
+   if (job.Atlas)
+   {
+      if (!job.Pixels)
+      {
+         std::cout << "ERROR::ATLAS: Failed to load " << job.File << std::endl;
+         return;
+      }
+      AtlasImage image;
+      image.Name = job.Name;
+      image.Sprite = job.Handle;
+      image.Width = job.Width;
+      image.Height = job.Height;
+      image.Pixels = job.Pixels; // Freed once packed by BuildAtlas()
+      pendingAtlasImages.push_back(image);
+      return;
+   }
+
+   // Same as loadTextureFromFile(), with the image already decoded
+   Texture2D texture;
+   if (job.Alpha)
+   {
+      texture.Internal_Format = GL_RGBA;
+      texture.Image_Format = GL_RGBA;
+   }
+   if (job.Pixels)
+      texture.Generate(job.Width, job.Height, job.Pixels);
+   else
+      std::cout << "ERROR::RESOURCEMANAGER: Failed to load texture " << job.File << std::endl;
+   stbi_image_free(job.Pixels);
+
+   Textures[job.Handle] = texture;
+   job.Texture.set_value(texture);
+}
+
+template <typename T>
+GLuint ResourceManager::intern(std::map<std::string, GLuint> &ids, std::vector<T> &storage, const std::string &name)
+{
+   auto iter = ids.find(name);
+   if (iter != ids.end())
+      return iter->second;
+   GLuint handle = storage.size();
+   storage.push_back(T());
+   ids[name] = handle;
+   return handle;
+}
+
+GLint ResourceManager::find(const std::map<std::string, GLuint> &ids, const std::string &name, const GLchar *kind)
+{
+   auto iter = ids.find(name);
+   if (iter != ids.end())
+      return iter->second;
+   std::cout << "ERROR::RESOURCEMANAGER: No " << kind << " named " << name << std::endl;
+   return -1;
+}
+
 Texture2D ResourceManager::loadTextureFromFile(const GLchar *file, GLboolean alpha)
 {
    // Create Texture object
@@ -7,12 +7,13 @@
 ** option) any later version.
 ******************************************************************/
 #include "shader.h"
+#include "gl_state.h"
 
 #include <iostream>
 
 Shader &Shader::Use()
 {
-   glUseProgram(this->ID);
+   GLState::UseProgram(this->ID);
    return *this;
 }
 
@@ -49,6 +50,7 @@ void Shader::Compile(const GLchar* vertexSource, const GLchar* fragmentSource, c
       glAttachShader(this->ID, gShader);
    glLinkProgram(this->ID);
    checkCompileErrors(this->ID, "PROGRAM");
+   resolveUniforms();
 
    // Delete the shaders as they're linked into our program now and no longer necessery
    glDeleteShader(sVertex);
@@ -57,59 +59,133 @@ void Shader::Compile(const GLchar* vertexSource, const GLchar* fragmentSource, c
       glDeleteShader(gShader);
 }
 
+GLint Shader::GetUniformLocation(const GLchar *name) const
+{
+   std::map<std::string, GLint>::const_iterator location = this->uniformLocations.find(name);
+   return location != this->uniformLocations.end() ? location->second : -1;
+}
+
 void Shader::SetFloat(const GLchar *name, GLfloat value, GLboolean useShader)
 {
    if (useShader)
       this->Use();
-   glUniform1f(glGetUniformLocation(this->ID, name), value);
+   glUniform1f(this->GetUniformLocation(name), value);
 }
 void Shader::SetInteger(const GLchar *name, GLint value, GLboolean useShader)
 {
    if (useShader)
       this->Use();
-   glUniform1i(glGetUniformLocation(this->ID, name), value);
+   glUniform1i(this->GetUniformLocation(name), value);
 }
 void Shader::SetVector2f(const GLchar *name, GLfloat x, GLfloat y, GLboolean useShader)
 {
    if (useShader)
       this->Use();
-   glUniform2f(glGetUniformLocation(this->ID, name), x, y);
+   glUniform2f(this->GetUniformLocation(name), x, y);
 }
 void Shader::SetVector2f(const GLchar *name, const glm::vec2 &value, GLboolean useShader)
 {
    if (useShader)
       this->Use();
-   glUniform2f(glGetUniformLocation(this->ID, name), value.x, value.y);
+   glUniform2f(this->GetUniformLocation(name), value.x, value.y);
 }
 void Shader::SetVector3f(const GLchar *name, GLfloat x, GLfloat y, GLfloat z, GLboolean useShader)
 {
    if (useShader)
       this->Use();
-   glUniform3f(glGetUniformLocation(this->ID, name), x, y, z);
+   glUniform3f(this->GetUniformLocation(name), x, y, z);
 }
 void Shader::SetVector3f(const GLchar *name, const glm::vec3 &value, GLboolean useShader)
 {
    if (useShader)
       this->Use();
-   glUniform3f(glGetUniformLocation(this->ID, name), value.x, value.y, value.z);
+   glUniform3f(this->GetUniformLocation(name), value.x, value.y, value.z);
 }
 void Shader::SetVector4f(const GLchar *name, GLfloat x, GLfloat y, GLfloat z, GLfloat w, GLboolean useShader)
 {
    if (useShader)
       this->Use();
-   glUniform4f(glGetUniformLocation(this->ID, name), x, y, z, w);
+   glUniform4f(this->GetUniformLocation(name), x, y, z, w);
 }
 void Shader::SetVector4f(const GLchar *name, const glm::vec4 &value, GLboolean useShader)
 {
    if (useShader)
       this->Use();
-   glUniform4f(glGetUniformLocation(this->ID, name), value.x, value.y, value.z, value.w);
+   glUniform4f(this->GetUniformLocation(name), value.x, value.y, value.z, value.w);
 }
 void Shader::SetMatrix4(const GLchar *name, const glm::mat4 &matrix, GLboolean useShader)
 {
    if (useShader)
       this->Use();
-   glUniformMatrix4fv(glGetUniformLocation(this->ID, name), 1, GL_FALSE, glm::value_ptr(matrix));
+   glUniformMatrix4fv(this->GetUniformLocation(name), 1, GL_FALSE, glm::value_ptr(matrix));
+}
+void Shader::SetFloat(GLint location, GLfloat value, GLboolean useShader)
+{
+   if (useShader)
+      this->Use();
+   glUniform1f(location, value);
+}
+void Shader::SetInteger(GLint location, GLint value, GLboolean useShader)
+{
+   if (useShader)
+      this->Use();
+   glUniform1i(location, value);
+}
+void Shader::SetVector2f(GLint location, const glm::vec2 &value, GLboolean useShader)
+{
+   if (useShader)
+      this->Use();
+   glUniform2f(location, value.x, value.y);
+}
+void Shader::SetVector3f(GLint location, const glm::vec3 &value, GLboolean useShader)
+{
+   if (useShader)
+      this->Use();
+   glUniform3f(location, value.x, value.y, value.z);
+}
+void Shader::SetVector4f(GLint location, const glm::vec4 &value, GLboolean useShader)
+{
+   if (useShader)
+      this->Use();
+   glUniform4f(location, value.x, value.y, value.z, value.w);
+}
+void Shader::SetMatrix4(GLint location, const glm::mat4 &matrix, GLboolean useShader)
+{
+   if (useShader)
+      this->Use();
+   glUniformMatrix4fv(location, 1, GL_FALSE, glm::value_ptr(matrix));
+}
+
+void Shader::resolveUniforms()
+{
+   // Query the locations of all active uniforms once, so setting them never has to ask the driver
+   this->uniformLocations.clear();
+   GLint numUniforms = 0;
+   glGetProgramiv(this->ID, GL_ACTIVE_UNIFORMS, &numUniforms);
+   for (GLint i = 0; i < numUniforms; ++i)
+   {
+      GLchar  name[256];
+      GLsizei length;
+      GLint   size;
+      GLenum  type;
+      glGetActiveUniform(this->ID, i, sizeof(name), &length, &size, &type, name);
+
+      // Uniforms that live in a uniform block have no location
+      GLint location = glGetUniformLocation(this->ID, name);
+      if (location < 0)
+         continue;
+
+      // Arrays are reported as "name[0]", but are set through "name"
+      std::string uniform(name, length);
+      if (uniform.size() > 3 && uniform.compare(uniform.size() - 3, 3, "[0]") == 0)
+         uniform.resize(uniform.size() - 3);
+      this->uniformLocations[uniform] = location;
+   }
+
+   // Connect the shared per-frame constants
+   GLuint frameConstants = glGetUniformBlockIndex(this->ID, "FrameConstants");
+   if (frameConstants != GL_INVALID_INDEX)
+      glUniformBlockBinding(this->ID, frameConstants, FRAME_CONSTANTS_BINDING);
 }
 
 
@@ -7,9 +7,15 @@
 ** option) any later version.
 ******************************************************************/
 #include "sprite_renderer.h"
+#include "gl_state.h"
 
+#include <cstddef>
 
-SpriteRenderer::SpriteRenderer(Shader &shader)
+
+SpriteRenderer::SpriteRenderer(const Shader &shader)
+    : instanceCapacity(0),
+      activeBatches(0),
+      batching(GL_FALSE)
 {
     this->shader = shader;
     this->initRenderData();
@@ -17,7 +23,8 @@ SpriteRenderer::SpriteRenderer(Shader &shader)
 
 SpriteRenderer::~SpriteRenderer()
 {
-    glDeleteVertexArrays(1, &this->quadVAO);
+    GLState::DeleteVertexArray(this->quadVAO);
+    glDeleteBuffers(1, &this->instanceVBO);
 }
 
 void SpriteRenderer::DrawSprite(Texture2D &texture,
@@ -26,34 +33,142 @@ void SpriteRenderer::DrawSprite(Texture2D &texture,
                                 GLfloat   rotate,
                                 glm::vec3 color)
 {
-    // Prepare transformations
-    this->shader.Use();
-    glm::mat4 model;
+    // Inside a batch the sprite simply joins the queue
+    if (this->batching)
+    {
+        this->Submit(texture, position, size, rotate, color);
+        return;
+    }
+
+    // Otherwise it is drawn right away as a batch of one
+    this->Begin();
+    this->Submit(texture, position, size, rotate, color);
+    this->Flush();
+}
+
+void SpriteRenderer::Begin()
+{
+    this->batching = GL_TRUE;
+}
+
+void SpriteRenderer::Submit(const Texture2D &texture,
+                            glm::vec2 position,
+                            glm::vec2 size,
+                            GLfloat   rotate,
+                            glm::vec3 color)
+{
+    this->Submit(SpriteRegion(texture), position, size, rotate, color);
+}
+
+void SpriteRenderer::Submit(const SpriteRegion &sprite,
+                            glm::vec2 position,
+                            glm::vec2 size,
+                            GLfloat   rotate,
+                            glm::vec3 color)
+{
+    SpriteInstance instance = { position, size, rotate, color, sprite.UV };
+    this->batchOf(sprite.Texture).Instances.push_back(instance);
+}
 
-    // Translate the quad to the right position
-    // The position specifies the location of the top left corner
-    model = glm::translate(model, glm::vec3(position, 0.0f));
+void SpriteRenderer::Submit(const SpriteRegion &sprite,
+                            const std::vector<glm::vec2> &positions,
+                            glm::vec2 size,
+                            GLfloat   rotate,
+                            glm::vec3 color)
+{
+    std::vector<SpriteInstance> &instances = this->batchOf(sprite.Texture).Instances;
+    SpriteInstance instance = { glm::vec2(0.0f), size, rotate, color, sprite.UV };
+    for (const glm::vec2 &position : positions)
+    {
+        instance.Position = position;
+        instances.push_back(instance);
+    }
+}
 
-    // Move the origin of rotation back to the top left corner
-    model = glm::translate(model, glm::vec3(0.5f * size.x, 0.5f * size.y, 0.0f));
-    // Rotate the quad around its center
-    model = glm::rotate(model, rotate, glm::vec3(0.0f, 0.0f, 1.0f));
-    // Move origin of rotation to the center of the quad
-    model = glm::translate(model, glm::vec3(-0.5f * size.x, -0.5f * size.y, 0.0f));
+SpriteRenderer::SpriteBatch &SpriteRenderer::batchOf(const Texture2D &texture)
+{
+    // Find the batch of this texture (there are only ever a handful of textures in a batch, so a linear search is fine)
+    GLuint batch = 0;
+    while (batch < this->activeBatches && this->batches[batch].TextureID != texture.ID)
+        ++batch;
+
+    // First sprite with this texture, so open a new batch
+    if (batch == this->activeBatches)
+    {
+        if (batch == this->batches.size())
+            this->batches.push_back(SpriteBatch());
+        this->batches[batch].TextureID = texture.ID;
+        ++this->activeBatches;
+    }
+
+    return this->batches[batch];
+}
 
-    // Scale the quad
-    model = glm::scale(model, glm::vec3(size, 1.0f));
+void SpriteRenderer::Flush()
+{
+    this->batching = GL_FALSE;
+
+    // Count the queued instances
+    GLuint numInstances = 0;
+    for (GLuint i = 0; i < this->activeBatches; ++i)
+        numInstances += this->batches[i].Instances.size();
+
+    if (numInstances == 0)
+    {
+        this->activeBatches = 0;
+        return;
+    }
+
+    glBindBuffer(GL_ARRAY_BUFFER, this->instanceVBO);
+
+    // Grow the instance buffer if needed, otherwise orphan it so the driver doesn't have to wait for the previous draws
+    while (this->instanceCapacity < numInstances)
+        this->instanceCapacity = this->instanceCapacity == 0 ? 256 : this->instanceCapacity * 2;
+    glBufferData(GL_ARRAY_BUFFER, this->instanceCapacity * sizeof(SpriteInstance), NULL, GL_STREAM_DRAW);
+
+    // Stream the instances of all batches back to back
+    GLuint offset = 0;
+    for (GLuint i = 0; i < this->activeBatches; ++i)
+    {
+        std::vector<SpriteInstance> &instances = this->batches[i].Instances;
+        glBufferSubData(GL_ARRAY_BUFFER, offset * sizeof(SpriteInstance), instances.size() * sizeof(SpriteInstance), &instances[0]);
+        offset += instances.size();
+    }
+
+    // Render one instanced quad per texture
+    this->shader.Use();
+    GLState::BlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+    GLState::ActiveTexture(0);
+    GLState::BindVertexArray(this->quadVAO);
+
+    offset = 0;
+    for (GLuint i = 0; i < this->activeBatches; ++i)
+    {
+        SpriteBatch &batch = this->batches[i];
+        this->setInstanceAttributes(offset);
+        GLState::BindTexture(batch.TextureID);
+        glDrawArraysInstanced(GL_TRIANGLES, 0, 6, batch.Instances.size());
+        offset += batch.Instances.size();
+
+        // Keep the storage around for the next frame
+        batch.Instances.clear();
+    }
 
-    // Render textured quad
-    this->shader.SetMatrix4("model", model);
-    this->shader.SetVector3f("spriteColor", color);
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
 
-    glActiveTexture(GL_TEXTURE0);
-    texture.Bind();
+    this->activeBatches = 0;
+}
 
-    glBindVertexArray(this->quadVAO);
-    glDrawArrays(GL_TRIANGLES, 0, 6);
-    glBindVertexArray(0);
+void SpriteRenderer::setInstanceAttributes(GLuint firstInstance)
+{
+    // GL 3.3 has no base instance, so the attribute pointers are offset instead
+    // Note that the instance buffer must be bound to GL_ARRAY_BUFFER when calling this
+    GLsizei stride = sizeof(SpriteInstance);
+    GLchar *base = (GLchar*)(firstInstance * sizeof(SpriteInstance));
+    glVertexAttribPointer(1, 4, GL_FLOAT, GL_FALSE, stride, (GLvoid*)(base + offsetof(SpriteInstance, Position))); // Position and size
+    glVertexAttribPointer(2, 1, GL_FLOAT, GL_FALSE, stride, (GLvoid*)(base + offsetof(SpriteInstance, Rotation)));
+    glVertexAttribPointer(3, 3, GL_FLOAT, GL_FALSE, stride, (GLvoid*)(base + offsetof(SpriteInstance, Color)));
+    glVertexAttribPointer(4, 4, GL_FLOAT, GL_FALSE, stride, (GLvoid*)(base + offsetof(SpriteInstance, TexRect)));
 }
 
 void SpriteRenderer::initRenderData()
@@ -117,9 +232,23 @@ void SpriteRenderer::initRenderData()
 
     // Configure VAO
     glGenVertexArrays(1, &this->quadVAO);
-    glBindVertexArray(this->quadVAO);
+    GLState::BindVertexArray(this->quadVAO);
     glEnableVertexAttribArray(0);
     glVertexAttribPointer(0, 4, GL_FLOAT, GL_FALSE, 4 * sizeof(GLfloat), (GLvoid*)0);
+
+    // Configure the per-instance attributes (the buffer itself is filled in Flush)
+    glGenBuffers(1, &this->instanceVBO);
+    glBindBuffer(GL_ARRAY_BUFFER, this->instanceVBO);
+    glEnableVertexAttribArray(1);
+    glEnableVertexAttribArray(2);
+    glEnableVertexAttribArray(3);
+    glEnableVertexAttribArray(4);
+    this->setInstanceAttributes(0);
+    glVertexAttribDivisor(1, 1);
+    glVertexAttribDivisor(2, 1);
+    glVertexAttribDivisor(3, 1);
+    glVertexAttribDivisor(4, 1);
+
     glBindBuffer(GL_ARRAY_BUFFER, 0);
-    glBindVertexArray(0);
-}
\ No newline at end of file
+    GLState::BindVertexArray(0);
+}
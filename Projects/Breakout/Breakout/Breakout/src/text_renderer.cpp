@@ -6,6 +6,9 @@
 ** Creative Commons, either version 4 of the License, or (at your
 ** option) any later version.
 ******************************************************************/
+#include <cmath>
+#include <cstddef>
+#include <cstring>
 #include <iostream>
 
 #include <glm/gtc/matrix_transform.hpp>
@@ -13,37 +16,58 @@
 #include FT_FREETYPE_H
 
 #include "text_renderer.h"
+#include "texture_atlas.h"
 #include "resource_manager.h"
+#include "gl_state.h"
 
 
-TextRenderer::TextRenderer(GLuint width, GLuint height)
+TextRenderer::TextRenderer()
+    : Characters(),
+      vertexCapacity(0),
+      batching(GL_FALSE),
+      cachedResized(GL_FALSE),
+      capHeight(0)
 {
-    // Load and configure the shader
+    // Load and configure the shader (the projection comes from the FrameConstants block)
     this->TextShader = ResourceManager::LoadShader("shaders/text.vs", "shaders/text.frag", nullptr, "text");
+    this->TextShader.SetInteger("text", 0, GL_TRUE);
 
-    this->TextShader.SetMatrix4("projection",
-                                glm::ortho(0.0f, static_cast<GLfloat>(width), static_cast<GLfloat>(height), 0.0f),
-                                GL_TRUE);
-
-    this->TextShader.SetInteger("text", 0);
-
-    // Configure VAO/VBO for texture quads
+    // Configure VAO/VBO for glyph quads (the VBO is (re)allocated in Flush once we know how many quads there are)
     glGenVertexArrays(1, &this->VAO);
     glGenBuffers(1, &this->VBO);
-    glBindVertexArray(this->VAO);
+    GLState::BindVertexArray(this->VAO);
     glBindBuffer(GL_ARRAY_BUFFER, this->VBO);
-    glBufferData(GL_ARRAY_BUFFER, sizeof(GLfloat) * 6 * 4, NULL, GL_DYNAMIC_DRAW); // 6 vertices of 4 floats (2 for coords and 2 for tex coords)
-    glEnableVertexAttribArray(0);
-    glVertexAttribPointer(0, 4, GL_FLOAT, GL_FALSE, 4 * sizeof(GLfloat), 0);
+    this->setVertexAttributes();
+
+    // Configure VAO/VBO for cached strings (the VBO is allocated in Flush once all cached strings are created)
+    glGenVertexArrays(1, &this->cachedVAO);
+    glGenBuffers(1, &this->cachedVBO);
+    GLState::BindVertexArray(this->cachedVAO);
+    glBindBuffer(GL_ARRAY_BUFFER, this->cachedVBO);
+    this->setVertexAttributes();
+
     glBindBuffer(GL_ARRAY_BUFFER, 0);
-    glBindVertexArray(0);
+    GLState::BindVertexArray(0);
 }
 
-void TextRenderer::Load(std::string font, GLuint fontSize)
+TextRenderer::~TextRenderer()
+{
+    GLState::DeleteVertexArray(this->VAO);
+    glDeleteBuffers(1, &this->VBO);
+    GLState::DeleteVertexArray(this->cachedVAO);
+    glDeleteBuffers(1, &this->cachedVBO);
+}
+
+void TextRenderer::setVertexAttributes()
 {
-    // Clear the previously loaded Characters
-    this->Characters.clear();
+    glEnableVertexAttribArray(0);
+    glVertexAttribPointer(0, 4, GL_FLOAT, GL_FALSE, sizeof(TextVertex), (GLvoid*)offsetof(TextVertex, Position)); // Position and texture coordinates
+    glEnableVertexAttribArray(1);
+    glVertexAttribPointer(1, 3, GL_FLOAT, GL_FALSE, sizeof(TextVertex), (GLvoid*)offsetof(TextVertex, Color));
+}
 
+void TextRenderer::Load(std::string font, GLuint fontSize)
+{
     // Initialize the FreeType library
     FT_Library ft;
     if (FT_Init_FreeType(&ft))
@@ -57,10 +81,16 @@ void TextRenderer::Load(std::string font, GLuint fontSize)
     // Set size to load glyphs as
     FT_Set_Pixel_Sizes(face, 0, fontSize);
 
-    // Disable the byte-alignment restriction and load/compile/store the first 128 ASCII characters of the font
-    glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
-    for (GLubyte c = 0; c < 128; c++)
+    // Rasterize the first 128 ASCII characters of the font
+    // FreeType reuses its glyph slot for every glyph, so each bitmap is copied out before loading the next one
+    std::vector<unsigned char> bitmaps[NUM_CHARACTERS];
+    glm::ivec2 bitmapSizes[NUM_CHARACTERS];
+    for (GLuint c = 0; c < NUM_CHARACTERS; c++)
     {
+        Character &character = this->Characters[c];
+        character = Character();
+        bitmapSizes[c] = glm::ivec2(0);
+
         // Load character glyph
         if (FT_Load_Char(face, c, FT_LOAD_RENDER))
         {
@@ -68,91 +98,409 @@ void TextRenderer::Load(std::string font, GLuint fontSize)
             continue;
         }
 
-        // Generate texture (8-bit grayscale image)
-        GLuint texture;
-        glGenTextures(1, &texture);
-        glBindTexture(GL_TEXTURE_2D, texture);
-        glTexImage2D(GL_TEXTURE_2D,
-                     0,
-                     GL_RED,
-                     face->glyph->bitmap.width,
-                     face->glyph->bitmap.rows,
-                     0,
-                     GL_RED,
-                     GL_UNSIGNED_BYTE,
-                     face->glyph->bitmap.buffer);
-
-        // Set texture options
-        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
-        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
-        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
-        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
-       
-        // Now store character for later use
-        Character character = { texture,
-                                glm::ivec2(face->glyph->bitmap.width, face->glyph->bitmap.rows),
-                                glm::ivec2(face->glyph->bitmap_left, face->glyph->bitmap_top),
-                                face->glyph->advance.x };
-
-        Characters.insert(std::pair<GLchar, Character>(c, character));
+        const FT_Bitmap &bitmap = face->glyph->bitmap;
+        bitmapSizes[c] = glm::ivec2(bitmap.width, bitmap.rows);
+        character.Size = glm::vec2(bitmap.width, bitmap.rows);
+        character.Bearing = glm::vec2(face->glyph->bitmap_left, face->glyph->bitmap_top);
+        character.Advance = static_cast<GLuint>(face->glyph->advance.x);
+
+        bitmaps[c].resize(bitmap.width * bitmap.rows);
+        for (GLuint row = 0; row < bitmap.rows; ++row)
+            std::memcpy(&bitmaps[c][row * bitmap.width], bitmap.buffer + row * bitmap.pitch, bitmap.width);
     }
+    this->capHeight = this->Characters['H'].Bearing.y;
 
-    glBindTexture(GL_TEXTURE_2D, 0);
+    this->buildGlyphAtlas(bitmaps, bitmapSizes);
+    this->TextShader.SetInteger("distanceField", GL_FALSE, GL_TRUE);
 
     // Destroy FreeType once we're finished
     FT_Done_Face(face);
     FT_Done_FreeType(ft);
 }
 
-void TextRenderer::RenderText(std::string text, GLfloat x, GLfloat y, GLfloat scale, glm::vec3 color)
+// Computes the squared distance from every pixel of a width x height grid to the closest pixel for which
+// feature is set, using the exact separable Euclidean distance transform of Felzenszwalb and Huttenlocher
+static void squaredDistanceTransform(const std::vector<GLboolean> &feature, GLint width, GLint height, std::vector<double> &distances)
 {
-    // Configure the shader
-    this->TextShader.Use();
-    this->TextShader.SetVector3f("textColor", color);
-    glActiveTexture(GL_TEXTURE0);
-    glBindVertexArray(this->VAO);
+    const double INF = 1e20;
+    distances.resize(width * height);
+    for (GLint i = 0; i < width * height; ++i)
+        distances[i] = feature[i] ? 0.0 : INF;
+
+    // Scratch space for the 1D transforms (f = input, d = output, v = parabola locations, z = parabola boundaries)
+    GLint n = glm::max(width, height);
+    std::vector<double> f(n), d(n), z(n + 1);
+    std::vector<GLint>  v(n);
+
+    // Runs the 1D transform over count samples of distances, starting at first and spaced stride apart
+    auto transform = [&](GLint first, GLint count, GLint stride)
+    {
+        for (GLint q = 0; q < count; ++q)
+            f[q] = distances[first + q * stride];
+
+        // Find the lower envelope of the parabolas rooted at every sample
+        GLint k = 0;
+        v[0] = 0;
+        z[0] = -INF;
+        z[1] = INF;
+        for (GLint q = 1; q < count; ++q)
+        {
+            double s;
+            while ((s = ((f[q] + q * q) - (f[v[k]] + v[k] * v[k])) / (2.0 * q - 2.0 * v[k])) <= z[k])
+                --k;
+            ++k;
+            v[k] = q;
+            z[k] = s;
+            z[k + 1] = INF;
+        }
+
+        // Sample the envelope
+        k = 0;
+        for (GLint q = 0; q < count; ++q)
+        {
+            while (z[k + 1] < q)
+                ++k;
+            d[q] = (q - v[k]) * (q - v[k]) + f[v[k]];
+        }
+
+        for (GLint q = 0; q < count; ++q)
+            distances[first + q * stride] = d[q];
+    };
+
+    // Columns first, then rows
+    for (GLint x = 0; x < width; ++x)
+        transform(x, height, width);
+    for (GLint y = 0; y < height; ++y)
+        transform(y * width, width, 1);
+}
+
+void TextRenderer::LoadDistanceField(std::string font, GLuint fontSize)
+{
+    // Initialize the FreeType library
+    FT_Library ft;
+    if (FT_Init_FreeType(&ft))
+        std::cout << "ERROR::FREETYPE: Could not init FreeType Library" << std::endl;
+
+    // Load font as face
+    FT_Face face;
+    if (FT_New_Face(ft, font.c_str(), 0, &face))
+        std::cout << "ERROR::FREETYPE: Failed to load font" << std::endl;
+
+    // Rasterize the glyphs much larger than they are stored, so the distances can be measured with sub-pixel precision
+    FT_Set_Pixel_Sizes(face, 0, SDF_GLYPH_SIZE * SDF_UPSAMPLING);
+
+    // The metrics are stored at fontSize so that a scale of 1.0f lays out text just like Load(font, fontSize) would
+    const GLfloat metricsScale = static_cast<GLfloat>(fontSize) / (SDF_GLYPH_SIZE * SDF_UPSAMPLING);
+    const GLint padding = SDF_SPREAD * SDF_UPSAMPLING;
+
+    std::vector<unsigned char> bitmaps[NUM_CHARACTERS];
+    glm::ivec2 bitmapSizes[NUM_CHARACTERS];
+    std::vector<GLboolean> inside, outside;
+    std::vector<double> toInside, toOutside;
+    for (GLuint c = 0; c < NUM_CHARACTERS; c++)
+    {
+        Character &character = this->Characters[c];
+        character = Character();
+        bitmapSizes[c] = glm::ivec2(0);
+
+        // Load character glyph
+        if (FT_Load_Char(face, c, FT_LOAD_RENDER))
+        {
+            std::cout << "ERROR::FREETYTPE: Failed to load Glyph" << std::endl;
+            continue;
+        }
+
+        const FT_Bitmap &bitmap = face->glyph->bitmap;
+        character.Advance = static_cast<GLuint>(face->glyph->advance.x * metricsScale);
+        if (bitmap.width == 0 || bitmap.rows == 0)
+            continue;
+
+        // Threshold the glyph into a grid with room for the spread around it
+        GLint width = bitmap.width + 2 * padding;
+        GLint height = bitmap.rows + 2 * padding;
+        inside.assign(width * height, GL_FALSE);
+        outside.assign(width * height, GL_TRUE);
+        for (GLuint row = 0; row < bitmap.rows; ++row)
+        {
+            for (GLuint column = 0; column < bitmap.width; ++column)
+            {
+                GLint i = (row + padding) * width + column + padding;
+                inside[i] = bitmap.buffer[row * bitmap.pitch + column] > 127;
+                outside[i] = !inside[i];
+            }
+        }
+        squaredDistanceTransform(inside, width, height, toInside);
+        squaredDistanceTransform(outside, width, height, toOutside);
+
+        // Downsample the signed distances, mapping the glyph's edge to 0.5 and SDF_SPREAD atlas pixels on either side to 0.0 and 1.0
+        glm::ivec2 size(width / SDF_UPSAMPLING, height / SDF_UPSAMPLING);
+        bitmaps[c].resize(size.x * size.y);
+        for (GLint y = 0; y < size.y; ++y)
+        {
+            for (GLint x = 0; x < size.x; ++x)
+            {
+                GLint i = (y * SDF_UPSAMPLING + SDF_UPSAMPLING / 2) * width + x * SDF_UPSAMPLING + SDF_UPSAMPLING / 2;
+                GLfloat distance = static_cast<GLfloat>(std::sqrt(toInside[i]) - std::sqrt(toOutside[i])) / SDF_UPSAMPLING;
+                GLfloat value = glm::clamp(0.5f - distance / (2.0f * SDF_SPREAD), 0.0f, 1.0f);
+                bitmaps[c][y * size.x + x] = static_cast<unsigned char>(value * 255.0f + 0.5f);
+            }
+        }
+
+        bitmapSizes[c] = size;
+        character.Size = glm::vec2(size * static_cast<GLint>(SDF_UPSAMPLING)) * metricsScale;
+        character.Bearing = glm::vec2(face->glyph->bitmap_left - padding, face->glyph->bitmap_top + padding) * metricsScale;
+    }
+    // The quads include the spread around the glyphs, which shouldn't move the text down
+    this->capHeight = this->Characters['H'].Bearing.y - padding * metricsScale;
+
+    this->buildGlyphAtlas(bitmaps, bitmapSizes);
+    this->TextShader.SetInteger("distanceField", GL_TRUE, GL_TRUE);
+
+    // Destroy FreeType once we're finished
+    FT_Done_Face(face);
+    FT_Done_FreeType(ft);
+}
+
+void TextRenderer::buildGlyphAtlas(const std::vector<unsigned char> bitmaps[NUM_CHARACTERS], const glm::ivec2 bitmapSizes[NUM_CHARACTERS])
+{
+    // Find the smallest square atlas that holds all the glyphs (with a pixel of padding between them)
+    GLuint atlasSize = 128;
+    glm::uvec2 positions[NUM_CHARACTERS];
+    for (;; atlasSize *= 2)
+    {
+        SkylinePacker packer(atlasSize, atlasSize);
+        GLboolean packed = GL_TRUE;
+        for (GLuint c = 0; c < NUM_CHARACTERS && packed; c++)
+            if (!bitmaps[c].empty())
+                packed = packer.Pack(bitmapSizes[c].x + 1, bitmapSizes[c].y + 1, positions[c]);
+        if (packed)
+            break;
+    }
+
+    // Copy the glyphs into the atlas
+    std::vector<unsigned char> pixels(atlasSize * atlasSize, 0);
+    for (GLuint c = 0; c < NUM_CHARACTERS; c++)
+    {
+        if (bitmaps[c].empty())
+            continue;
+
+        for (GLint row = 0; row < bitmapSizes[c].y; ++row)
+            std::memcpy(&pixels[(positions[c].y + row) * atlasSize + positions[c].x], &bitmaps[c][row * bitmapSizes[c].x], bitmapSizes[c].x);
+
+        this->Characters[c].UV = glm::vec4(positions[c].x, positions[c].y, bitmapSizes[c].x, bitmapSizes[c].y) / static_cast<GLfloat>(atlasSize);
+    }
+
+    // Generate the atlas texture (8-bit grayscale image)
+    // Disable the byte-alignment restriction since every texel is a single byte
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+    this->GlyphAtlas.Internal_Format = GL_RED;
+    this->GlyphAtlas.Image_Format = GL_RED;
+    this->GlyphAtlas.Wrap_S = GL_CLAMP_TO_EDGE;
+    this->GlyphAtlas.Wrap_T = GL_CLAMP_TO_EDGE;
+    this->GlyphAtlas.Generate(atlasSize, atlasSize, &pixels[0]);
+
+    // The glyph metrics changed, so all cached strings have to be laid out again
+    for (CachedText &cached : this->cachedTexts)
+        cached.Valid = GL_FALSE;
+}
+
+void TextRenderer::RenderText(const std::string &text, GLfloat x, GLfloat y, GLfloat scale, glm::vec3 color)
+{
+    // Outside of a batch the text is drawn right away
+    GLboolean drawNow = !this->batching;
+    if (drawNow)
+        this->Begin();
+
+    // Lay out the glyphs right after the already queued ones
+    GLuint first = this->vertices.size();
+    this->vertices.resize(first + text.size() * 6);
+    GLuint count = this->layoutText(text.c_str(), x, y, scale, color, this->vertices.data() + first, text.size());
+    this->vertices.resize(first + count);
+
+    if (drawNow)
+        this->Flush();
+}
+
+TextHandle TextRenderer::CreateCachedText(GLuint maxLength)
+{
+    CachedText cached;
+    cached.X = cached.Y = cached.Scale = 0.0f;
+    cached.Color = glm::vec3(1.0f);
+    cached.FirstVertex = this->cachedVertices.size();
+    cached.MaxVertices = maxLength * 6;
+    cached.NumVertices = 0;
+    cached.Valid = GL_FALSE;
+
+    this->cachedVertices.resize(cached.FirstVertex + cached.MaxVertices);
+    this->cachedResized = GL_TRUE;
+    this->cachedTexts.push_back(cached);
+    return this->cachedTexts.size() - 1;
+}
+
+void TextRenderer::RenderCachedText(TextHandle handle, const GLchar *text, GLfloat x, GLfloat y, GLfloat scale, glm::vec3 color)
+{
+    CachedText &cached = this->cachedTexts[handle];
+
+    // Only lay out the string again if something about it changed
+    if (!cached.Valid || cached.X != x || cached.Y != y || cached.Scale != scale || cached.Color != color || cached.Text != text)
+    {
+        cached.Text = text;
+        cached.X = x;
+        cached.Y = y;
+        cached.Scale = scale;
+        cached.Color = color;
+        cached.NumVertices = this->layoutText(text, x, y, scale, color, &this->cachedVertices[cached.FirstVertex], cached.MaxVertices / 6);
+        cached.Valid = GL_TRUE;
+
+        // Upload just this string's range (unless the whole buffer is reallocated in the next Flush anyway)
+        if (!this->cachedResized && cached.NumVertices > 0)
+        {
+            glBindBuffer(GL_ARRAY_BUFFER, this->cachedVBO);
+            glBufferSubData(GL_ARRAY_BUFFER,
+                            cached.FirstVertex * sizeof(TextVertex),
+                            cached.NumVertices * sizeof(TextVertex),
+                            &this->cachedVertices[cached.FirstVertex]);
+            glBindBuffer(GL_ARRAY_BUFFER, 0);
+        }
+    }
+
+    if (cached.NumVertices == 0)
+        return;
+
+    // Outside of a batch the text is drawn right away
+    GLboolean drawNow = !this->batching;
+    if (drawNow)
+        this->Begin();
+
+    this->cachedFirsts.push_back(cached.FirstVertex);
+    this->cachedCounts.push_back(cached.NumVertices);
+
+    if (drawNow)
+        this->Flush();
+}
 
+GLuint TextRenderer::layoutText(const GLchar *text, GLfloat x, GLfloat y, GLfloat scale, glm::vec3 color, TextVertex *out, GLuint maxGlyphs) const
+{
     // Iterate through all the characters of the string
-    std::string::const_iterator c;
-    for (c = text.begin(); c != text.end(); c++)
+    GLuint numGlyphs = 0;
+    for (const GLchar *c = text; *c != '\0' && numGlyphs < maxGlyphs; ++c)
     {
-        Character ch = Characters[*c];
+        GLubyte code = static_cast<GLubyte>(*c);
+        if (code >= NUM_CHARACTERS)
+            continue;
+        const Character &ch = this->Characters[code];
 
         // See Text Rendering tutorial to understand these calculations
         GLfloat xpos = x + ch.Bearing.x * scale;
-        GLfloat ypos = y + (this->Characters['H'].Bearing.y - ch.Bearing.y) * scale;
+        GLfloat ypos = y + (this->capHeight - ch.Bearing.y) * scale;
 
         GLfloat w = ch.Size.x * scale;
         GLfloat h = ch.Size.y * scale;
 
-        // Update VBO with the appropriate dimensions for each character
+        GLfloat u0 = ch.UV.x, v0 = ch.UV.y;
+        GLfloat u1 = ch.UV.x + ch.UV.z, v1 = ch.UV.y + ch.UV.w;
+
+        // Write the glyph's quad
         // The vertices are specified in ccwise order
         // The texture coordinates are inverted vertically (origin at top left instead of bottom left)
-        GLfloat vertices[6][4] = {
-            { xpos,     ypos + h,   0.0, 1.0 }, // Bottom left
-            { xpos + w, ypos,       1.0, 0.0 }, // Top Right
-            { xpos,     ypos,       0.0, 0.0 }, // Top left
+        TextVertex *quad = out + numGlyphs * 6;
+        quad[0] = { glm::vec2(xpos,     ypos + h), glm::vec2(u0, v1), color }; // Bottom left
+        quad[1] = { glm::vec2(xpos + w, ypos),     glm::vec2(u1, v0), color }; // Top Right
+        quad[2] = { glm::vec2(xpos,     ypos),     glm::vec2(u0, v0), color }; // Top left
 
-            { xpos,     ypos + h,   0.0, 1.0 }, // Bottom left
-            { xpos + w, ypos + h,   1.0, 1.0 }, // Bottom right
-            { xpos + w, ypos,       1.0, 0.0 }  // Top right
-        };
+        quad[3] = { glm::vec2(xpos,     ypos + h), glm::vec2(u0, v1), color }; // Bottom left
+        quad[4] = { glm::vec2(xpos + w, ypos + h), glm::vec2(u1, v1), color }; // Bottom right
+        quad[5] = { glm::vec2(xpos + w, ypos),     glm::vec2(u1, v0), color }; // Top right
+        ++numGlyphs;
 
-        // Render glyph texture over quad
-        glBindTexture(GL_TEXTURE_2D, ch.TextureID);
+        // Now advance cursors for next glyph (note that advance is specified in 1/64 pixels)
+        x += (ch.Advance / 64.0f) * scale; // Divide by 64 to get value in pixels (distance field metrics are scaled, so they aren't whole pixels)
+    }
+
+    return numGlyphs * 6;
+}
+
+void TextRenderer::Begin()
+{
+    this->batching = GL_TRUE;
+}
+
+void TextRenderer::Flush()
+{
+    this->batching = GL_FALSE;
+    if (this->vertices.empty() && this->cachedFirsts.empty())
+        return;
+
+    // Configure the shader
+    this->TextShader.Use();
+    GLState::BlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+    GLState::ActiveTexture(0);
+    this->GlyphAtlas.Bind();
+
+    if (!this->vertices.empty())
+    {
+        GLState::BindVertexArray(this->VAO);
 
-        // Update content of VBO memory
+        // Upload all queued quads at once (growing the VBO if needed, otherwise orphaning it)
         glBindBuffer(GL_ARRAY_BUFFER, this->VBO);
-        glBufferSubData(GL_ARRAY_BUFFER, 0, sizeof(vertices), vertices); // Be sure to use glBufferSubData and not glBufferData
+        while (this->vertexCapacity < this->vertices.size())
+            this->vertexCapacity = this->vertexCapacity == 0 ? 1024 : this->vertexCapacity * 2;
+        glBufferData(GL_ARRAY_BUFFER, this->vertexCapacity * sizeof(TextVertex), NULL, GL_DYNAMIC_DRAW);
+        glBufferSubData(GL_ARRAY_BUFFER, 0, this->vertices.size() * sizeof(TextVertex), &this->vertices[0]);
         glBindBuffer(GL_ARRAY_BUFFER, 0);
 
-        // Render quad
-        glDrawArrays(GL_TRIANGLES, 0, 6);
+        // Render all glyphs
+        glDrawArrays(GL_TRIANGLES, 0, this->vertices.size());
 
-        // Now advance cursors for next glyph (note that advance is specified in 1/64 pixels)
-        x += (ch.Advance >> 6) * scale; // Bitshift by 6 to get value in pixels (2^6 = 64 (divide amount of 1/64th pixels by 64 to get amount of pixels))
+        // Keep the storage around for the next frame
+        this->vertices.clear();
     }
 
-    glBindVertexArray(0);
-    glBindTexture(GL_TEXTURE_2D, 0);
+    if (!this->cachedFirsts.empty())
+    {
+        // New cached strings were created since the last Flush, so the buffer has to grow
+        if (this->cachedResized)
+        {
+            glBindBuffer(GL_ARRAY_BUFFER, this->cachedVBO);
+            glBufferData(GL_ARRAY_BUFFER, this->cachedVertices.size() * sizeof(TextVertex), &this->cachedVertices[0], GL_STATIC_DRAW);
+            glBindBuffer(GL_ARRAY_BUFFER, 0);
+            this->cachedResized = GL_FALSE;
+        }
+
+        // Render all the queued cached strings at once
+        GLState::BindVertexArray(this->cachedVAO);
+        glMultiDrawArrays(GL_TRIANGLES, &this->cachedFirsts[0], &this->cachedCounts[0], this->cachedFirsts.size());
+
+        this->cachedFirsts.clear();
+        this->cachedCounts.clear();
+    }
+}
+
+GLuint FormatInteger(GLint value, GLchar *buffer)
+{
+    if (value >= 0)
+        return FormatInteger(static_cast<GLuint>(value), buffer);
+
+    // Negated as unsigned, since the magnitude of the most negative value doesn't fit in a GLint
+    buffer[0] = '-';
+    return 1 + FormatInteger(0u - static_cast<GLuint>(value), buffer + 1);
+}
+
+GLuint FormatInteger(GLuint value, GLchar *buffer)
+{
+    // Collect the digits back to front, then copy them over in the right order
+    GLchar digits[10];
+    GLuint numDigits = 0;
+    do
+    {
+        digits[numDigits++] = '0' + value % 10;
+        value /= 10;
+    } while (value > 0);
+
+    GLuint length = 0;
+    while (numDigits > 0)
+        buffer[length++] = digits[--numDigits];
+    buffer[length] = '\0';
+
+    return length;
 }
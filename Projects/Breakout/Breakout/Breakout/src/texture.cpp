@@ -9,20 +9,23 @@
 #include <iostream>
 
 #include "texture.h"
+#include "gl_state.h"
 
 
 Texture2D::Texture2D()
-   : Width(0), Height(0), Internal_Format(GL_RGB), Image_Format(GL_RGB), Wrap_S(GL_REPEAT), Wrap_T(GL_REPEAT), Filter_Min(GL_LINEAR), Filter_Max(GL_LINEAR)
+   : ID(0), Width(0), Height(0), Internal_Format(GL_RGB), Image_Format(GL_RGB), Wrap_S(GL_REPEAT), Wrap_T(GL_REPEAT), Filter_Min(GL_LINEAR), Filter_Max(GL_LINEAR)
 {
-   glGenTextures(1, &this->ID);
+
 }
 
 void Texture2D::Generate(GLuint width, GLuint height, unsigned char* data)
 {
    this->Width = width;
    this->Height = height;
-   // Create Texture
-   glBindTexture(GL_TEXTURE_2D, this->ID);
+   // Create Texture (the texture object itself only the first time)
+   if (this->ID == 0)
+      glGenTextures(1, &this->ID);
+   GLState::BindTexture(this->ID);
    glTexImage2D(GL_TEXTURE_2D, 0, this->Internal_Format, width, height, 0, this->Image_Format, GL_UNSIGNED_BYTE, data);
    // Set Texture wrap and filter modes
    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, this->Wrap_S);
@@ -30,10 +33,10 @@ void Texture2D::Generate(GLuint width, GLuint height, unsigned char* data)
    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, this->Filter_Min);
    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, this->Filter_Max);
    // Unbind texture
-   glBindTexture(GL_TEXTURE_2D, 0);
+   GLState::BindTexture(0);
 }
 
 void Texture2D::Bind() const
 {
-   glBindTexture(GL_TEXTURE_2D, this->ID);
+   GLState::BindTexture(this->ID);
 }
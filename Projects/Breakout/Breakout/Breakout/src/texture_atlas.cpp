@@ -0,0 +1,103 @@
+/*******************************************************************
+** This code is part of Breakout.
+**
+** Breakout is free software: you can redistribute it and/or modify
+** it under the terms of the CC BY 4.0 license as published by
+** Creative Commons, either version 4 of the License, or (at your
+** option) any later version.
+******************************************************************/
+#include "texture_atlas.h"
+
+
+SkylinePacker::SkylinePacker(GLuint width, GLuint height)
+    : width(width), height(height)
+{
+    // The page starts out empty, so the skyline is a single segment spanning the bottom of the page
+    Segment floor = { 0, 0, this->width };
+    this->skyline.push_back(floor);
+}
+
+GLboolean SkylinePacker::Pack(GLuint width, GLuint height, glm::uvec2 &position)
+{
+    // Find the segment on which the rectangle rests the lowest (ties are broken by the narrowest segment)
+    GLint bestSegment = -1, bestTop = this->height + 1, bestWidth = 0;
+    for (GLuint i = 0; i < this->skyline.size(); ++i)
+    {
+        GLint y = this->fit(i, width, height);
+        if (y < 0)
+            continue;
+
+        GLint top = y + height;
+        if (top < bestTop || (top == bestTop && this->skyline[i].Width < bestWidth))
+        {
+            bestSegment = i;
+            bestTop = top;
+            bestWidth = this->skyline[i].Width;
+        }
+    }
+
+    if (bestSegment < 0)
+        return GL_FALSE;
+
+    // Raise the skyline where the rectangle was placed
+    Segment placed = { this->skyline[bestSegment].X, bestTop, static_cast<GLint>(width) };
+    position = glm::uvec2(placed.X, bestTop - height);
+    this->skyline.insert(this->skyline.begin() + bestSegment, placed);
+
+    // Cut the segments that are now covered by the new one
+    for (GLuint i = bestSegment + 1; i < this->skyline.size(); )
+    {
+        Segment &previous = this->skyline[i - 1];
+        Segment &current = this->skyline[i];
+        GLint overlap = previous.X + previous.Width - current.X;
+        if (overlap <= 0)
+            break;
+
+        if (current.Width <= overlap)
+        {
+            this->skyline.erase(this->skyline.begin() + i);
+        }
+        else
+        {
+            current.X += overlap;
+            current.Width -= overlap;
+            break;
+        }
+    }
+
+    // Merge neighbouring segments at the same height
+    for (GLuint i = 0; i + 1 < this->skyline.size(); )
+    {
+        if (this->skyline[i].Y == this->skyline[i + 1].Y)
+        {
+            this->skyline[i].Width += this->skyline[i + 1].Width;
+            this->skyline.erase(this->skyline.begin() + i + 1);
+        }
+        else
+        {
+            ++i;
+        }
+    }
+
+    return GL_TRUE;
+}
+
+GLint SkylinePacker::fit(GLuint segment, GLint width, GLint height) const
+{
+    GLint x = this->skyline[segment].X;
+    if (x + width > this->width)
+        return -1;
+
+    // The rectangle rests on the highest segment it spans
+    GLint y = 0;
+    GLint widthLeft = width;
+    for (GLuint i = segment; widthLeft > 0; ++i)
+    {
+        y = glm::max(y, this->skyline[i].Y);
+        if (y + height > this->height)
+            return -1;
+        widthLeft -= this->skyline[i].Width;
+    }
+
+    return y;
+}
@@ -0,0 +1,190 @@
+/*******************************************************************
+** This code is part of Breakout.
+**
+** Breakout is free software: you can redistribute it and/or modify
+** it under the terms of the CC BY 4.0 license as published by
+** Creative Commons, either version 4 of the License, or (at your
+** option) any later version.
+******************************************************************/
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+
+#include "game_simulation.h"
+#include "input_recording.h"
+#include "profiler.h"
+
+// Plays games of Breakout without a window, a GPU or an audio device, as fast as possible.
+// Usage: BreakoutSim [games] [level] [profile.csv]
+//        BreakoutSim --replay <recording.brec>
+// When a profile file is given every update is profiled, and the timings of the last updates are written to it
+// A recording made by the game (Breakout --record <file>) is replayed tick by tick, and the final state is
+// checked against the one the game recorded; the exit code is 1 if they differ
+// Must be run from the Breakout project directory, since the levels are loaded from levels/*.blvl
+
+// Size of the playing field (same as the window of the game)
+const GLuint FIELD_WIDTH = 800;
+const GLuint FIELD_HEIGHT = 600;
+// Every update advances the game by the same amount of time
+const GLfloat TIMESTEP = 1.0f / 60.0f;
+// Games that take longer than this are abandoned (e.g. when the ball got stuck bouncing between solid bricks)
+const GLuint MAX_TICKS_PER_GAME = 60 * 60 * 10;
+
+// Moves the paddle underneath the lowest ball
+void Autopilot(GameSimulation &sim)
+{
+    GLuint lowest = 0;
+    for (GLuint i = 1; i < sim.Balls.Count(); ++i)
+        if (sim.Balls.Positions[i].y > sim.Balls.Positions[lowest].y)
+            lowest = i;
+
+    GLfloat paddleCenter = sim.Player.Position.x + sim.Player.Size.x / 2;
+    GLfloat ballCenter = sim.Balls.Positions[lowest].x + BALL_RADIUS;
+    GLfloat distance = ballCenter - paddleCenter;
+
+    // Don't overshoot, and aim a little off center so the ball doesn't keep bouncing straight up
+    GLfloat step = PLAYER_VELOCITY * TIMESTEP;
+    GLfloat aim = distance + sim.Player.Size.x / 5;
+    if (std::abs(aim) > step)
+        sim.MovePlayer(aim > 0.0f ? 1.0f : -1.0f, TIMESTEP);
+
+    sim.LaunchBalls();
+}
+
+// Replays an input recording as fast as possible
+int Replay(const GLchar *file)
+{
+    InputReplayer replayer;
+    if (!replayer.Open(file))
+        return -1;
+
+    // Start out the same way the game did
+    GameSimulation sim(FIELD_WIDTH, FIELD_HEIGHT);
+    sim.Init();
+    if (sim.Levels[0].Bricks.empty())
+    {
+        std::cout << "ERROR::BREAKOUTSIM: Failed to load the levels, run from the Breakout directory" << std::endl;
+        return -1;
+    }
+    if (replayer.Header.Level >= sim.Levels.size())
+    {
+        std::cout << "ERROR::BREAKOUTSIM: Recording starts in level " << replayer.Header.Level << ", but there are only " << sim.Levels.size() << " levels" << std::endl;
+        return -1;
+    }
+    sim.RNG.Seed(replayer.Header.Seed);
+    sim.Level = replayer.Header.Level;
+    sim.State = GAME_MENU;
+
+    // Nothing starts profiler frames here, so the zones would only be timed to be thrown away
+    Profiler::Enabled = GL_FALSE;
+
+    const GLfloat dt = 1.0f / replayer.Header.TickRate;
+    KeyState keys;
+    auto start = std::chrono::steady_clock::now();
+    while (replayer.Next(keys))
+    {
+        sim.ProcessInput(keys, dt);
+        sim.Update(dt);
+    }
+    std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+
+    // Any difference in the final state means the simulation no longer plays out the way it did when recorded
+    GLuint64 hash = sim.StateHash();
+    GLboolean matches = hash == replayer.StateHash;
+    std::cout << "Ticks:     " << replayer.Ticks << " (" << replayer.Ticks / replayer.Header.TickRate << "s of play)" << std::endl;
+    std::cout << "Time:      " << elapsed.count() << "s" << std::endl;
+    std::cout << "Ticks/sec: " << replayer.Ticks / elapsed.count() << std::endl;
+    std::cout << "Hash:      " << std::hex << hash << std::dec;
+    if (matches)
+        std::cout << " (matches the recording)" << std::endl;
+    else
+        std::cout << " MISMATCH, the recording ended in " << std::hex << replayer.StateHash << std::dec << std::endl;
+    return matches ? 0 : 1;
+}
+
+int main(int argc, char *argv[])
+{
+    if (argc > 1 && std::strcmp(argv[1], "--replay") == 0)
+    {
+        if (argc < 3)
+        {
+            std::cout << "Usage: BreakoutSim --replay <recording.brec>" << std::endl;
+            return -1;
+        }
+        return Replay(argv[2]);
+    }
+
+    GLuint games = argc > 1 ? std::atoi(argv[1]) : 1000;
+    GLuint level = argc > 2 ? std::atoi(argv[2]) % 4 : 0;
+    const GLchar *profileFile = argc > 3 ? argv[3] : nullptr;
+    Profiler::Enabled = profileFile != nullptr;
+
+    GameSimulation sim(FIELD_WIDTH, FIELD_HEIGHT);
+    sim.Init();
+    sim.Level = level;
+    if (sim.Levels[level].Bricks.empty())
+    {
+        std::cout << "ERROR::BREAKOUTSIM: Failed to load the levels, run from the Breakout directory" << std::endl;
+        return -1;
+    }
+
+    GLuint wins = 0, abandoned = 0, mostBalls = 0;
+    unsigned long long ticks = 0, bricks = 0;
+    auto start = std::chrono::steady_clock::now();
+
+    for (GLuint game = 0; game < games; ++game)
+    {
+        sim.ResetLevel();
+        sim.PowerUps.clear();
+        sim.ResetPlayer();
+        sim.Lives = INITIAL_LIVES;
+        sim.State = GAME_ACTIVE;
+
+        GLuint tick = 0;
+        for (; tick < MAX_TICKS_PER_GAME && sim.State == GAME_ACTIVE; ++tick)
+        {
+            Profiler::BeginFrame();
+            Autopilot(sim);
+            {
+                ProfileScope profile(ZONE_UPDATE);
+                sim.Update(TIMESTEP);
+            }
+
+            mostBalls = glm::max(mostBalls, sim.Balls.Count());
+            for (const SimulationEvent &event : sim.Events)
+                if (event.Type == BRICK_DESTROYED)
+                    ++bricks;
+        }
+
+        ticks += tick;
+        if (sim.State == GAME_WIN)
+            ++wins;
+        else if (sim.State == GAME_ACTIVE)
+            ++abandoned;
+    }
+
+    std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+    std::cout << "Games:     " << games << " (" << wins << " won, " << abandoned << " abandoned)" << std::endl;
+    std::cout << "Updates:   " << ticks << std::endl;
+    std::cout << "Bricks:    " << bricks << " destroyed" << std::endl;
+    std::cout << "Balls:     " << mostBalls << " at most" << std::endl;
+    std::cout << "Time:      " << elapsed.count() << "s" << std::endl;
+    std::cout << "Games/sec: " << games / elapsed.count() << std::endl;
+    std::cout << "Updates/sec: " << ticks / elapsed.count() << std::endl;
+    std::cout << "Hash:      " << std::hex << sim.StateHash() << std::dec << std::endl;
+
+    if (profileFile)
+    {
+        // Statistics of the last updates (in milliseconds)
+        for (ProfileZone zone : { ZONE_UPDATE, ZONE_COLLISIONS })
+        {
+            ProfileStats stats = Profiler::Stats(zone);
+            std::cout << Profiler::ZoneName(zone) << ": min " << stats.Min << " avg " << stats.Average << " p99 " << stats.P99 << " ms" << std::endl;
+        }
+        if (!Profiler::WriteCSV(profileFile))
+            return -1;
+    }
+    return 0;
+}
@@ -0,0 +1,70 @@
+#ifndef GL_STATE_H
+#define GL_STATE_H
+
+#include <glad/glad.h>
+
+#include <array>
+
+// Shadows the pieces of OpenGL state that change all the time (the bound program, VAO, 2D texture per unit,
+// blend function and the blend/depth test/face culling capabilities) and only forwards calls that change something
+// All state changes must go through GLState, otherwise the shadow copy goes stale (call invalidate() if that happens)
+class GLState
+{
+public:
+
+   // Number of calls per kind of state change
+   struct Counters
+   {
+      unsigned int programs;
+      unsigned int vertexArrays;
+      unsigned int activeTextures;
+      unsigned int textures;
+      unsigned int blendFuncs;
+      unsigned int capabilities;
+
+      unsigned int total() const { return programs + vertexArrays + activeTextures + textures + blendFuncs + capabilities; }
+   };
+
+   GLState() = delete;
+
+   static void            useProgram(unsigned int program);
+   static void            bindVertexArray(unsigned int vertexArray);
+   static void            activeTexture(unsigned int unit);  // Takes the index of the unit, not GL_TEXTURE0 + index
+   static void            bindTexture(unsigned int texture); // Binds a GL_TEXTURE_2D texture to the active unit
+   static void            blendFunc(GLenum sourceFactor, GLenum destinationFactor);
+   static void            enable(GLenum capability);
+   static void            disable(GLenum capability);
+
+   // Deleting a bound object resets its binding to 0, so deletions must go through here as well
+   static void            deleteProgram(unsigned int program);
+   static void            deleteVertexArray(unsigned int vertexArray);
+   static void            deleteTexture(unsigned int texture);
+
+   // Forgets everything, so the next call of each kind is always forwarded
+   static void            invalidate();
+
+   // Calls that were forwarded to the driver and calls that were elided since the last resetCounters()
+   static const Counters& getIssuedCounters();
+   static const Counters& getSkippedCounters();
+   static void            resetCounters();
+
+private:
+
+   static void            setCapability(GLenum capability, bool enabled);
+
+   static constexpr unsigned int                 mUnknown           = 0xFFFFFFFF;
+   static constexpr unsigned int                 mNumTrackedTexUnits = 16;
+
+   static unsigned int                           mProgram;
+   static unsigned int                           mVertexArray;
+   static unsigned int                           mActiveUnit;
+   static std::array<unsigned int, mNumTrackedTexUnits> mTextures;
+   static GLenum                                 mBlendSourceFactor;
+   static GLenum                                 mBlendDestinationFactor;
+   static std::array<unsigned int, 3>            mCapabilities; // GL_BLEND, GL_DEPTH_TEST and GL_CULL_FACE
+
+   static Counters                               mIssued;
+   static Counters                               mSkipped;
+};
+
+#endif
@@ -7,6 +7,7 @@
 #include "play_state.h"
 #include "pause_state.h"
 #include "win_state.h"
+#include "gl_state.h"
 #include "game.h"
 
 Game::Game()
@@ -199,12 +200,28 @@ void Game::executeGameLoop()
    double lastFrame    = 0.0;
    float  deltaTime    = 0.0f;
 
+   // GL state changes that were forwarded to the driver and that were elided, summed over all frames
+   unsigned long long numFrames      = 0;
+   unsigned long long issuedChanges  = 0;
+   unsigned long long skippedChanges = 0;
+
    while (!mWindow->shouldClose())
    {
       currentFrame = glfwGetTime();
       deltaTime    = static_cast<float>(currentFrame - lastFrame);
       lastFrame    = currentFrame;
 
+      GLState::resetCounters();
       mFSM->executeCurrentState(deltaTime);
+
+      ++numFrames;
+      issuedChanges  += GLState::getIssuedCounters().total();
+      skippedChanges += GLState::getSkippedCounters().total();
+   }
+
+   if (numFrames > 0)
+   {
+      std::cout << "GL state changes per frame: " << issuedChanges / numFrames << " issued, "
+                << skippedChanges / numFrames << " skipped (over " << numFrames << " frames)" << "\n";
    }
 }
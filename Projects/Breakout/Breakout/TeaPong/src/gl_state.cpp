@@ -0,0 +1,186 @@
+#include "gl_state.h"
+
+unsigned int                                        GLState::mProgram                = GLState::mUnknown;
+unsigned int                                        GLState::mVertexArray            = GLState::mUnknown;
+unsigned int                                        GLState::mActiveUnit             = GLState::mUnknown;
+std::array<unsigned int, GLState::mNumTrackedTexUnits> GLState::mTextures          = {GLState::mUnknown, GLState::mUnknown, GLState::mUnknown, GLState::mUnknown,
+                                                                                      GLState::mUnknown, GLState::mUnknown, GLState::mUnknown, GLState::mUnknown,
+                                                                                      GLState::mUnknown, GLState::mUnknown, GLState::mUnknown, GLState::mUnknown,
+                                                                                      GLState::mUnknown, GLState::mUnknown, GLState::mUnknown, GLState::mUnknown};
+GLenum                                              GLState::mBlendSourceFactor      = GLState::mUnknown;
+GLenum                                              GLState::mBlendDestinationFactor = GLState::mUnknown;
+std::array<unsigned int, 3>                         GLState::mCapabilities           = {GLState::mUnknown, GLState::mUnknown, GLState::mUnknown};
+GLState::Counters                                   GLState::mIssued                 = {};
+GLState::Counters                                   GLState::mSkipped                = {};
+
+void GLState::useProgram(unsigned int program)
+{
+   if (program == mProgram)
+   {
+      ++mSkipped.programs;
+      return;
+   }
+
+   glUseProgram(program);
+   mProgram = program;
+   ++mIssued.programs;
+}
+
+void GLState::bindVertexArray(unsigned int vertexArray)
+{
+   if (vertexArray == mVertexArray)
+   {
+      ++mSkipped.vertexArrays;
+      return;
+   }
+
+   glBindVertexArray(vertexArray);
+   mVertexArray = vertexArray;
+   ++mIssued.vertexArrays;
+}
+
+void GLState::activeTexture(unsigned int unit)
+{
+   if (unit == mActiveUnit)
+   {
+      ++mSkipped.activeTextures;
+      return;
+   }
+
+   glActiveTexture(GL_TEXTURE0 + unit);
+   mActiveUnit = unit;
+   ++mIssued.activeTextures;
+}
+
+void GLState::bindTexture(unsigned int texture)
+{
+   // Bindings of units we don't track (or of an unknown unit) are always forwarded
+   bool tracked = mActiveUnit < mNumTrackedTexUnits;
+   if (tracked && mTextures[mActiveUnit] == texture)
+   {
+      ++mSkipped.textures;
+      return;
+   }
+
+   glBindTexture(GL_TEXTURE_2D, texture);
+   if (tracked)
+   {
+      mTextures[mActiveUnit] = texture;
+   }
+   ++mIssued.textures;
+}
+
+void GLState::blendFunc(GLenum sourceFactor, GLenum destinationFactor)
+{
+   if (sourceFactor == mBlendSourceFactor && destinationFactor == mBlendDestinationFactor)
+   {
+      ++mSkipped.blendFuncs;
+      return;
+   }
+
+   glBlendFunc(sourceFactor, destinationFactor);
+   mBlendSourceFactor      = sourceFactor;
+   mBlendDestinationFactor = destinationFactor;
+   ++mIssued.blendFuncs;
+}
+
+void GLState::enable(GLenum capability)
+{
+   setCapability(capability, true);
+}
+
+void GLState::disable(GLenum capability)
+{
+   setCapability(capability, false);
+}
+
+void GLState::deleteProgram(unsigned int program)
+{
+   if (program == mProgram)
+   {
+      mProgram = 0;
+   }
+   glDeleteProgram(program);
+}
+
+void GLState::deleteVertexArray(unsigned int vertexArray)
+{
+   if (vertexArray == mVertexArray)
+   {
+      mVertexArray = 0;
+   }
+   glDeleteVertexArrays(1, &vertexArray);
+}
+
+void GLState::deleteTexture(unsigned int texture)
+{
+   // The texture is unbound from every unit it is bound to
+   for (unsigned int& boundTexture : mTextures)
+   {
+      if (boundTexture == texture)
+      {
+         boundTexture = 0;
+      }
+   }
+   glDeleteTextures(1, &texture);
+}
+
+void GLState::invalidate()
+{
+   mProgram                = mUnknown;
+   mVertexArray            = mUnknown;
+   mActiveUnit             = mUnknown;
+   mTextures.fill(mUnknown);
+   mBlendSourceFactor      = mUnknown;
+   mBlendDestinationFactor = mUnknown;
+   mCapabilities.fill(mUnknown);
+}
+
+const GLState::Counters& GLState::getIssuedCounters()
+{
+   return mIssued;
+}
+
+const GLState::Counters& GLState::getSkippedCounters()
+{
+   return mSkipped;
+}
+
+void GLState::resetCounters()
+{
+   mIssued  = {};
+   mSkipped = {};
+}
+
+void GLState::setCapability(GLenum capability, bool enabled)
+{
+   int index = -1;
+   switch (capability)
+   {
+   case GL_BLEND:      index = 0; break;
+   case GL_DEPTH_TEST: index = 1; break;
+   case GL_CULL_FACE:  index = 2; break;
+   }
+
+   // Capabilities we don't track (e.g. GL_MULTISAMPLE) are always forwarded
+   if (index >= 0 && mCapabilities[index] == static_cast<unsigned int>(enabled))
+   {
+      ++mSkipped.capabilities;
+      return;
+   }
+
+   if (enabled)
+   {
+      glEnable(capability);
+   }
+   else
+   {
+      glDisable(capability);
+   }
+
+   if (index >= 0)
+   {
+      mCapabilities[index] = enabled;
+   }
+   ++mIssued.capabilities;
+}
@@ -1,3 +1,4 @@
+#include "gl_state.h"
 #include "menu_state.h"
 
 float calculateCWAngularPosOnXYPlaneWRTNegYAxisInDeg(const glm::vec3& point);
@@ -132,7 +133,7 @@ void MenuState::render()
    glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
 
    // Enable depth testing for 3D objects
-   glEnable(GL_DEPTH_TEST);
+   GLState::enable(GL_DEPTH_TEST);
 
    mGameObject3DShader->use();
    mGameObject3DShader->setMat4("view", glm::lookAt(mCameraPosition, mCameraTarget, mCameraUp));
@@ -148,9 +149,9 @@ void MenuState::render()
    mLeftPaddle->render(*mGameObject3DShader);
    mRightPaddle->render(*mGameObject3DShader);
 
-   glDisable(GL_CULL_FACE);
+   GLState::disable(GL_CULL_FACE);
    mBall->render(*mGameObject3DShader);
-   glEnable(GL_CULL_FACE);
+   GLState::enable(GL_CULL_FACE);
 
    mWindow->swapBuffers();
    mWindow->pollEvents();
@@ -1,5 +1,6 @@
 #include <iostream>
 
+#include "gl_state.h"
 #include "mesh.h"
 
 Mesh::Mesh(const std::vector<Vertex>&       vertices,
@@ -13,7 +14,7 @@ Mesh::Mesh(const std::vector<Vertex>&       vertices,
 
 Mesh::~Mesh()
 {
-   glDeleteVertexArrays(1, &mVAO);
+   GLState::deleteVertexArray(mVAO);
 }
 
 Mesh::Mesh(Mesh&& rhs) noexcept
@@ -38,9 +39,8 @@ void Mesh::render(const Shader& shader) const
    setMaterialTextureAvailabilities(shader);
    setMaterialConstants(shader);
 
-   glBindVertexArray(mVAO);
+   GLState::bindVertexArray(mVAO);
    glDrawElements(GL_TRIANGLES, mNumIndices, GL_UNSIGNED_INT, 0);
-   glBindVertexArray(0);
 }
 
 void Mesh::configureVAO(const std::vector<Vertex>& vertices, const std::vector<unsigned int>& indices)
@@ -51,7 +51,7 @@ void Mesh::configureVAO(const std::vector<Vertex>& vertices, const std::vector<u
    glGenBuffers(1, &VBO);
    glGenBuffers(1, &EBO);
 
-   glBindVertexArray(mVAO);
+   GLState::bindVertexArray(mVAO);
 
    // Load the mesh's data into the buffers
 
@@ -74,14 +74,14 @@ void Mesh::configureVAO(const std::vector<Vertex>& vertices, const std::vector<u
    glEnableVertexAttribArray(2);
    glVertexAttribPointer(2, 2, GL_FLOAT, GL_FALSE, sizeof(Vertex), (void*)offsetof(Vertex, texCoords));
 
-   glBindVertexArray(0);
+   GLState::bindVertexArray(0);
    glDeleteBuffers(1, &VBO);
    glDeleteBuffers(1, &EBO);
 }
 
 void Mesh::bindMaterialTextures(const Shader& shader) const
 {
-   unsigned int texUnit = GL_TEXTURE0;
+   unsigned int texUnit = 0;
 
    for (unsigned int i = 0; i < mMaterial.textures.size(); ++i)
    {
@@ -91,7 +91,7 @@ void Mesh::bindMaterialTextures(const Shader& shader) const
       if (uniformLoc != -1)
       {
          // Activate the proper texture unit before binding the current texture
-         glActiveTexture(texUnit);
+         GLState::activeTexture(texUnit);
          // Tell the sampler2D uniform in what texture unit to look for the texture data
          glUniform1i(uniformLoc, i);
          // Bind the texture
@@ -105,7 +105,7 @@ void Mesh::bindMaterialTextures(const Shader& shader) const
       }
    }
 
-   glActiveTexture(GL_TEXTURE0);
+   GLState::activeTexture(0);
 }
 
 void Mesh::setMaterialTextureAvailabilities(const Shader& shader) const
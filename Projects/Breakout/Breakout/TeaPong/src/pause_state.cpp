@@ -1,3 +1,4 @@
+#include "gl_state.h"
 #include "pause_state.h"
 
    PauseState::PauseState(const std::shared_ptr<FiniteStateMachine>& finiteStateMachine,
@@ -82,7 +83,7 @@ void PauseState::render()
    glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
 
    // Enable depth testing for 3D objects
-   glEnable(GL_DEPTH_TEST);
+   GLState::enable(GL_DEPTH_TEST);
 
    mGameObject3DShader->use();
    mGameObject3DShader->setMat4("view", mCamera->getViewMatrix());
@@ -93,9 +94,9 @@ void PauseState::render()
    mLeftPaddle->render(*mGameObject3DShader);
    mRightPaddle->render(*mGameObject3DShader);
 
-   glDisable(GL_CULL_FACE);
+   GLState::disable(GL_CULL_FACE);
    mBall->render(*mGameObject3DShader);
-   glEnable(GL_CULL_FACE);
+   GLState::enable(GL_CULL_FACE);
 
    mWindow->swapBuffers();
    mWindow->pollEvents();
@@ -2,6 +2,7 @@
 #include <random>
 
 #include "collision.h"
+#include "gl_state.h"
 #include "play_state.h"
 
 void resolveCollisionBetweenBallAndPaddle(Ball& ball, const Paddle& paddle, const glm::vec2& vecFromCenterOfCircleToPointOfCollision);
@@ -178,7 +179,7 @@ void PlayState::render()
    glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
 
    // Enable depth testing for 3D objects
-   glEnable(GL_DEPTH_TEST);
+   GLState::enable(GL_DEPTH_TEST);
 
    mGameObject3DShader->use();
    mGameObject3DShader->setMat4("view", mCamera->getViewMatrix());
@@ -189,9 +190,9 @@ void PlayState::render()
    mLeftPaddle->render(*mGameObject3DShader);
    mRightPaddle->render(*mGameObject3DShader);
 
-   glDisable(GL_CULL_FACE);
+   GLState::disable(GL_CULL_FACE);
    mBall->render(*mGameObject3DShader);
-   glEnable(GL_CULL_FACE);
+   GLState::enable(GL_CULL_FACE);
 
    mWindow->swapBuffers();
    mWindow->pollEvents();
@@ -2,6 +2,7 @@
 
 #include <array>
 
+#include "gl_state.h"
 #include "renderer_2D.h"
 
 Renderer2D::Renderer2D(const std::shared_ptr<Shader>& shader)
@@ -12,7 +13,7 @@ Renderer2D::Renderer2D(const std::shared_ptr<Shader>& shader)
 
 Renderer2D::~Renderer2D()
 {
-   glDeleteVertexArrays(1, &mVAO);
+   GLState::deleteVertexArray(mVAO);
 }
 
 Renderer2D::Renderer2D(Renderer2D&& rhs) noexcept
@@ -34,13 +35,12 @@ void Renderer2D::render(const GameObject2D& gameObj2D) const
    mShader->use();
    mShader->setMat4("model", gameObj2D.getModelMatrix());
 
-   glActiveTexture(GL_TEXTURE0);
+   GLState::activeTexture(0);
    gameObj2D.getTexture()->bind();
 
    // Render textured quad
-   glBindVertexArray(mVAO);
+   GLState::bindVertexArray(mVAO);
    glDrawElements(GL_TRIANGLES, 6, GL_UNSIGNED_INT, 0);
-   glBindVertexArray(0);
 }
 
 void Renderer2D::configureVAO()
@@ -80,7 +80,7 @@ void Renderer2D::configureVAO()
    glGenBuffers(1, &VBO);
    glGenBuffers(1, &EBO);
 
-   glBindVertexArray(mVAO);
+   GLState::bindVertexArray(mVAO);
 
    // Load the quad's data into the buffers
 
@@ -97,7 +97,7 @@ void Renderer2D::configureVAO()
    glEnableVertexAttribArray(0);
    glVertexAttribPointer(0, 4, GL_FLOAT, GL_FALSE, 4 * sizeof(float), (void*)0);
 
-   glBindVertexArray(0);
+   GLState::bindVertexArray(0);
    glDeleteBuffers(1, &VBO);
    glDeleteBuffers(1, &EBO);
 }
@@ -1,5 +1,6 @@
 #include <iostream>
 
+#include "gl_state.h"
 #include "shader.h"
 
 Shader::Shader(unsigned int shaderProgID)
@@ -10,7 +11,7 @@ Shader::Shader(unsigned int shaderProgID)
 
 Shader::~Shader()
 {
-   glDeleteProgram(mShaderProgID);
+   GLState::deleteProgram(mShaderProgID);
 }
 
 Shader::Shader(Shader&& rhs) noexcept
@@ -27,7 +28,7 @@ Shader& Shader::operator=(Shader&& rhs) noexcept
 
 void Shader::use() const
 {
-   glUseProgram(mShaderProgID);
+   GLState::useProgram(mShaderProgID);
 }
 
 unsigned int Shader::getID() const
@@ -1,5 +1,6 @@
 #include <utility>
 
+#include "gl_state.h"
 #include "texture.h"
 
 Texture::Texture(unsigned int texID)
@@ -10,7 +11,7 @@ Texture::Texture(unsigned int texID)
 
 Texture::~Texture()
 {
-   glDeleteTextures(1, &mTexID);
+   GLState::deleteTexture(mTexID);
 }
 
 Texture::Texture(Texture&& rhs) noexcept
@@ -27,5 +28,5 @@ Texture& Texture::operator=(Texture&& rhs) noexcept
 
 void Texture::bind() const
 {
-   glBindTexture(GL_TEXTURE_2D, mTexID);
+   GLState::bindTexture(mTexID);
 }
@@ -2,6 +2,7 @@
 
 #include <iostream>
 
+#include "gl_state.h"
 #include "texture_loader.h"
 
 std::shared_ptr<Texture> TextureLoader::loadResource(const std::string& texFilePath,
@@ -50,7 +51,7 @@ unsigned int TextureLoader::generateTexture(const std::unique_ptr<unsigned char,
 
    unsigned int texID;
    glGenTextures(1, &texID);
-   glBindTexture(GL_TEXTURE_2D, texID);
+   GLState::bindTexture(texID);
    glTexImage2D(GL_TEXTURE_2D, 0, format, width, height, 0, format, GL_UNSIGNED_BYTE, texData.get());
 
    if (genMipmap)
@@ -63,7 +64,7 @@ unsigned int TextureLoader::generateTexture(const std::unique_ptr<unsigned char,
    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, minFilter);
    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, magFilter);
 
-   glBindTexture(GL_TEXTURE_2D, 0);
+   GLState::bindTexture(0);
 
    return texID;
 }
@@ -1,3 +1,4 @@
+#include "gl_state.h"
 #include "win_state.h"
 
 WinState::WinState(const std::shared_ptr<FiniteStateMachine>& finiteStateMachine,
@@ -90,7 +91,7 @@ void WinState::render(float deltaTime)
    glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
 
    // Enable depth testing for 3D objects
-   glEnable(GL_DEPTH_TEST);
+   GLState::enable(GL_DEPTH_TEST);
 
    mGameObject3DExplosiveShader->use();
    mGameObject3DExplosiveShader->setMat4("view", glm::lookAt(mCameraPosition, mCameraTarget, mCameraUp));
@@ -104,9 +105,9 @@ void WinState::render(float deltaTime)
       mGameObject3DExplosiveShader->setFloat("distanceToMove", 0.0f);
    }
 
-   glDisable(GL_CULL_FACE);
+   GLState::disable(GL_CULL_FACE);
    mBall->render(*mGameObject3DExplosiveShader);
-   glEnable(GL_CULL_FACE);
+   GLState::enable(GL_CULL_FACE);
 
    mWindow->swapBuffers();
    mWindow->pollEvents();
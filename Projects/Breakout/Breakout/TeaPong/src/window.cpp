@@ -1,5 +1,6 @@
 #include <iostream>
 
+#include "gl_state.h"
 #include "window.h"
 
 Window::Window(unsigned int widthInPix, unsigned int heightInPix, const std::string& title)
@@ -72,10 +73,10 @@ bool Window::initialize()
    }
 
    glViewport(0, 0, mWidthInPix, mHeightInPix);
-   glEnable(GL_CULL_FACE);
-   glEnable(GL_BLEND);
-   glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
-   glEnable(GL_MULTISAMPLE);
+   GLState::enable(GL_CULL_FACE);
+   GLState::enable(GL_BLEND);
+   GLState::blendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+   GLState::enable(GL_MULTISAMPLE);
 
    return true;
 }
@@ -0,0 +1,165 @@
+/*******************************************************************
+** This code is part of Breakout.
+**
+** Breakout is free software: you can redistribute it and/or modify
+** it under the terms of the CC BY 4.0 license as published by
+** Creative Commons, either version 4 of the License, or (at your
+** option) any later version.
+******************************************************************/
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <map>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "level_format.h"
+
+// levelc compiles the text levels (.lvl) into the binary format the game loads (.blvl, see level_format.h).
+// Usage: levelc <input.lvl> <output.blvl>
+//
+// A text level is a grid of tile codes separated by spaces, one row of tiles per line.
+// Code 0 is an empty tile, 1 a solid brick and 2-5 colored bricks (any other code is a white brick).
+// The look of a code can be changed, or new codes added, with a line of the form:
+//   color <code> <red> <green> <blue> [solid]
+// Lines starting with # are comments.
+//
+// The compiled levels are checked in next to their sources, so after editing levels/<name>.lvl run
+// (from the Breakout directory): levelc levels/<name>.lvl levels/<name>.blvl
+
+// The look of the tile codes that aren't given a color by the level itself
+LevelPaletteEntry DefaultTileType(GLuint code)
+{
+    LevelPaletteEntry type = { glm::vec3(1.0f), 0 }; // original: white
+    if (code == 1)
+        type = { glm::vec3(0.8f, 0.8f, 0.7f), 1 };
+    else if (code == 2)
+        type.Color = glm::vec3(0.2f, 0.6f, 1.0f);
+    else if (code == 3)
+        type.Color = glm::vec3(0.0f, 0.7f, 0.0f);
+    else if (code == 4)
+        type.Color = glm::vec3(0.8f, 0.8f, 0.4f);
+    else if (code == 5)
+        type.Color = glm::vec3(1.0f, 0.5f, 0.0f);
+    return type;
+}
+
+int main(int argc, char *argv[])
+{
+    if (argc != 3)
+    {
+        std::cout << "Usage: levelc <input.lvl> <output.blvl>" << std::endl;
+        return -1;
+    }
+
+    std::ifstream input(argv[1]);
+    if (!input)
+    {
+        std::cout << "ERROR::LEVELC: Failed to read level: " << argv[1] << std::endl;
+        return -1;
+    }
+
+    // Parse the text level
+    std::map<GLuint, LevelPaletteEntry> tileTypes; // Tile types given by the level itself, by code
+    std::vector<std::vector<GLuint>> rows;
+    std::string line;
+    for (GLuint lineNumber = 1; std::getline(input, line); ++lineNumber)
+    {
+        std::istringstream sstream(line);
+        std::string word;
+        if (!(sstream >> word) || word[0] == '#')
+            continue;
+
+        if (word == "color")
+        {
+            GLuint code;
+            LevelPaletteEntry type = { glm::vec3(1.0f), 0 };
+            std::string solid;
+            if (!(sstream >> code >> type.Color.r >> type.Color.g >> type.Color.b) || code == 0)
+            {
+                std::cout << "ERROR::LEVELC: " << argv[1] << "(" << lineNumber << "): Expected color <code> <red> <green> <blue> [solid]" << std::endl;
+                return -1;
+            }
+            if (sstream >> solid)
+                type.Solid = solid == "solid";
+            tileTypes[code] = type;
+            continue;
+        }
+
+        // A row of tiles
+        std::vector<GLuint> row;
+        sstream.clear();
+        sstream.str(line);
+        GLuint code;
+        while (sstream >> code) // Read each word seperated by spaces
+            row.push_back(code);
+        if (!sstream.eof())
+        {
+            std::cout << "ERROR::LEVELC: " << argv[1] << "(" << lineNumber << "): Tiles must be numbers" << std::endl;
+            return -1;
+        }
+        if (!rows.empty() && row.size() != rows[0].size())
+        {
+            std::cout << "ERROR::LEVELC: " << argv[1] << "(" << lineNumber << "): All rows must have the same number of tiles" << std::endl;
+            return -1;
+        }
+        rows.push_back(row);
+    }
+
+    // Build the palette out of the codes that are used, and the tile grid that indexes it
+    LevelFileHeader header;
+    std::memcpy(header.Magic, LEVEL_FILE_MAGIC, sizeof(header.Magic));
+    header.Version = LEVEL_FILE_VERSION;
+    header.Height = rows.size();
+    header.Width = rows.empty() ? 0 : rows[0].size();
+    header.NumBricks = 0;
+
+    std::vector<LevelPaletteEntry> palette;
+    std::map<GLuint, GLubyte> paletteTiles; // Tile of each code in the palette
+    std::vector<GLubyte> tiles;
+    tiles.reserve(header.Width * header.Height);
+    for (const std::vector<GLuint> &row : rows)
+    {
+        for (GLuint code : row)
+        {
+            if (code == 0)
+            {
+                tiles.push_back(0);
+                continue;
+            }
+
+            if (paletteTiles.find(code) == paletteTiles.end())
+            {
+                if (palette.size() == MAX_LEVEL_COLORS)
+                {
+                    std::cout << "ERROR::LEVELC: " << argv[1] << ": A level can't use more than " << MAX_LEVEL_COLORS << " different tiles" << std::endl;
+                    return -1;
+                }
+                auto type = tileTypes.find(code);
+                palette.push_back(type != tileTypes.end() ? type->second : DefaultTileType(code));
+                paletteTiles[code] = static_cast<GLubyte>(palette.size());
+            }
+            tiles.push_back(paletteTiles[code]);
+            ++header.NumBricks;
+        }
+    }
+    header.NumColors = palette.size();
+
+    // Write the compiled level
+    std::ofstream output(argv[2], std::ios::binary);
+    output.write(reinterpret_cast<const GLchar*>(&header), sizeof(header));
+    if (!palette.empty())
+        output.write(reinterpret_cast<const GLchar*>(&palette[0]), palette.size() * sizeof(LevelPaletteEntry));
+    if (!tiles.empty())
+        output.write(reinterpret_cast<const GLchar*>(&tiles[0]), tiles.size());
+    if (!output)
+    {
+        std::cout << "ERROR::LEVELC: Failed to write level: " << argv[2] << std::endl;
+        return -1;
+    }
+
+    std::cout << argv[1] << " -> " << argv[2] << ": " << header.Width << "x" << header.Height << " tiles, "
+              << header.NumBricks << " bricks, " << header.NumColors << " colors" << std::endl;
+    return 0;
+}